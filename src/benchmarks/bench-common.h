@@ -0,0 +1,140 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_BENCHMARKS_BENCH_COMMON_H
+#define CONDUIT_SRC_BENCHMARKS_BENCH_COMMON_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "perf-counters.h"
+
+namespace sst::conduit::benchmarks
+{
+struct BenchOptions
+{
+    bool perfCounters{false};
+    // Instances alive at once in the lifecycle benchmark; a large project's worth. Activated
+    // plugins hold their DSP buffers (the polymetric delay is around 8MB each), so lower it
+    // with --instances N on a small machine.
+    int instances{1000};
+    std::string filter{};
+
+    static BenchOptions fromArgs(int argc, char **argv)
+    {
+        BenchOptions res;
+        for (int i = 1; i < argc; ++i)
+        {
+            if (strcmp(argv[i], "--perf") == 0)
+                res.perfCounters = true;
+            else if (strcmp(argv[i], "--instances") == 0 && i + 1 < argc)
+                res.instances = std::max(1, atoi(argv[++i]));
+            else
+                res.filter = argv[i];
+        }
+        return res;
+    }
+
+    bool wants(const std::string &name) const
+    {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+};
+
+/*
+ * Makes the compiler treat v as used, so the work which computed it can't be dropped or
+ * hoisted out of a measured loop, without storing it anywhere.
+ */
+template <typename V> inline void doNotOptimize(const V &v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(v) : "memory");
+#else
+    volatile V sink = v;
+    (void)sink;
+#endif
+}
+
+/*
+ * Executables which replace the global operator new point this at their running count,
+ * and measure then also reports heap allocations per iteration.
+ */
+inline std::atomic<uint64_t> *allocationCounter{nullptr};
+
+/*
+ * Time a region (and count it, with --perf) and print per iteration figures. The body
+ * runs `iterations` times between one start and one stop, so counter overhead is
+ * amortized and the numbers describe the steady state of the kernel.
+ */
+template <typename F>
+void measure(const BenchOptions &opt, const std::string &name, uint64_t iterations, F &&body,
+             double realTimeNsPerIteration = 0)
+{
+    if (!opt.wants(name))
+        return;
+
+    PerfCounters pc;
+    if (opt.perfCounters && !pc.open())
+        fprintf(stderr, "%s: perf counters unavailable, timing only\n", name.c_str());
+
+    uint64_t allocs0 = allocationCounter ? allocationCounter->load() : 0;
+    pc.start();
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i)
+        body(i);
+    auto t1 = std::chrono::steady_clock::now();
+    pc.stop();
+    uint64_t allocs1 = allocationCounter ? allocationCounter->load() : 0;
+
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+    auto per = 1.0 * ns / iterations;
+    printf("%-40s %12.1f ns/iter", name.c_str(), per);
+    if (realTimeNsPerIteration > 0)
+        printf("  %6.2f%% realtime", 100.0 * per / realTimeNsPerIteration);
+    if (allocationCounter)
+        printf("  allocs=%.2f", 1.0 * (allocs1 - allocs0) / iterations);
+
+    if (pc.isOpen())
+    {
+        for (int c = 0; c < PerfCounters::nCounters; ++c)
+        {
+            if (pc.available[c])
+                printf("  %s=%.1f", PerfCounters::names[c], 1.0 * pc.values[c] / iterations);
+            else
+                printf("  %s=n/a", PerfCounters::names[c]);
+        }
+        if (pc.available[PerfCounters::CYCLES] && pc.available[PerfCounters::INSTRUCTIONS] &&
+            pc.values[PerfCounters::CYCLES] > 0)
+        {
+            printf("  ipc=%.2f", 1.0 * pc.values[PerfCounters::INSTRUCTIONS] /
+                                     pc.values[PerfCounters::CYCLES]);
+        }
+    }
+    printf("\n");
+}
+} // namespace sst::conduit::benchmarks
+
+#endif // CONDUIT_SRC_BENCHMARKS_BENCH_COMMON_H
@@ -0,0 +1,232 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_BENCHMARKS_BENCH_HOST_H
+#define CONDUIT_SRC_BENCHMARKS_BENCH_HOST_H
+
+/*
+ * Just enough of a clap host to load Conduit plugins through the factory and push audio
+ * and notes through them without a DAW. It offers no extensions, so the plugins run as
+ * they would under the most minimal host.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <clap/clap.h>
+
+namespace sst::conduit::benchmarks
+{
+struct BenchHost
+{
+    clap_host host{};
+
+    BenchHost()
+    {
+        host.clap_version = CLAP_VERSION;
+        host.host_data = this;
+        host.name = "Conduit Bench";
+        host.vendor = "Surge Synth Team";
+        host.url = "";
+        host.version = "1.0";
+        host.get_extension = [](auto, auto) -> const void * { return nullptr; };
+        host.request_restart = [](auto) {};
+        host.request_process = [](auto) {};
+        host.request_callback = [](auto) {};
+    }
+};
+
+struct EventQueue
+{
+    std::vector<clap_event_note> notes;
+    clap_input_events in{};
+    clap_output_events out{};
+
+    EventQueue()
+    {
+        notes.reserve(256);
+        in.ctx = this;
+        in.size = [](auto l) { return (uint32_t) static_cast<EventQueue *>(l->ctx)->notes.size(); };
+        in.get = [](auto l, auto i) -> const clap_event_header_t * {
+            return &static_cast<EventQueue *>(l->ctx)->notes[i].header;
+        };
+        out.ctx = this;
+        out.try_push = [](auto, auto) { return true; };
+    }
+
+    void note(bool on, int16_t key, uint32_t time = 0, int32_t noteId = -1)
+    {
+        clap_event_note n{};
+        n.header.size = sizeof(clap_event_note);
+        n.header.time = time;
+        n.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        n.header.type = on ? CLAP_EVENT_NOTE_ON : CLAP_EVENT_NOTE_OFF;
+        n.port_index = 0;
+        n.channel = 0;
+        n.key = key;
+        n.note_id = noteId;
+        n.velocity = 0.8;
+        notes.push_back(n);
+    }
+    void clear() { notes.clear(); }
+};
+
+/*
+ * An in memory clap stream pair, so state save and load can round trip without files.
+ */
+struct StateBuffer
+{
+    std::vector<uint8_t> data;
+    size_t readPos{0};
+    clap_ostream os{};
+    clap_istream is{};
+
+    StateBuffer()
+    {
+        data.reserve(64 * 1024);
+        os.ctx = this;
+        os.write = [](auto s, auto buf, auto size) -> int64_t {
+            auto sb = static_cast<StateBuffer *>(s->ctx);
+            auto b = static_cast<const uint8_t *>(buf);
+            sb->data.insert(sb->data.end(), b, b + size);
+            return (int64_t)size;
+        };
+        is.ctx = this;
+        is.read = [](auto s, auto buf, auto size) -> int64_t {
+            auto sb = static_cast<StateBuffer *>(s->ctx);
+            auto n = std::min((size_t)size, sb->data.size() - sb->readPos);
+            memcpy(buf, sb->data.data() + sb->readPos, n);
+            sb->readPos += n;
+            return (int64_t)n;
+        };
+    }
+
+    void clearForWrite()
+    {
+        data.clear();
+        readPos = 0;
+    }
+    void rewind() { readPos = 0; }
+};
+
+/*
+ * Owns one plugin instance and stereo buffers for each of its audio ports. The
+ * lifecycle calls are separate so a benchmark can time them individually.
+ */
+struct PluginRunner
+{
+    BenchHost bh;
+    EventQueue events;
+    const clap_plugin *plugin{nullptr};
+    double sampleRate{48000};
+    uint32_t blockSize{512};
+
+    struct Port
+    {
+        std::vector<float> storage;
+        std::vector<float *> chans;
+        clap_audio_buffer buffer{};
+    };
+    std::vector<Port> inPorts, outPorts;
+    std::vector<clap_audio_buffer> inBuffers, outBuffers;
+    int64_t steadyTime{0};
+
+    PluginRunner(const clap_plugin_factory *f, const char *id, double sr, uint32_t bs)
+        : sampleRate(sr), blockSize(bs)
+    {
+        plugin = f->create_plugin(f, &bh.host, id);
+    }
+    ~PluginRunner()
+    {
+        if (plugin)
+            plugin->destroy(plugin);
+    }
+
+    bool init()
+    {
+        if (!plugin || !plugin->init(plugin))
+            return false;
+
+        auto ap = static_cast<const clap_plugin_audio_ports *>(
+            plugin->get_extension(plugin, CLAP_EXT_AUDIO_PORTS));
+        if (ap)
+        {
+            for (int isIn = 0; isIn < 2; ++isIn)
+            {
+                auto &ports = isIn ? inPorts : outPorts;
+                ports.resize(ap->count(plugin, isIn));
+                for (auto i = 0U; i < ports.size(); ++i)
+                {
+                    clap_audio_port_info info{};
+                    ap->get(plugin, i, isIn, &info);
+                    auto &p = ports[i];
+                    p.storage.assign(info.channel_count * blockSize, 0.f);
+                    for (auto c = 0U; c < info.channel_count; ++c)
+                        p.chans.push_back(p.storage.data() + c * blockSize);
+                    p.buffer.data32 = p.chans.data();
+                    p.buffer.channel_count = info.channel_count;
+                }
+            }
+        }
+        for (auto &p : inPorts)
+            inBuffers.push_back(p.buffer);
+        for (auto &p : outPorts)
+            outBuffers.push_back(p.buffer);
+
+        // A quiet, deterministic input signal for the effects
+        for (auto &p : inPorts)
+            for (auto i = 0U; i < p.storage.size(); ++i)
+                p.storage[i] = 0.25f * std::sin(i * 0.0314f);
+        return true;
+    }
+
+    bool activate() { return plugin->activate(plugin, sampleRate, 1, blockSize); }
+    bool startProcessing() { return plugin->start_processing(plugin); }
+    void stopProcessing() { plugin->stop_processing(plugin); }
+    void deactivate() { plugin->deactivate(plugin); }
+
+    clap_process_status processBlock()
+    {
+        clap_process p{};
+        p.steady_time = steadyTime;
+        p.frames_count = blockSize;
+        p.transport = nullptr;
+        p.audio_inputs = inBuffers.data();
+        p.audio_inputs_count = (uint32_t)inBuffers.size();
+        p.audio_outputs = outBuffers.data();
+        p.audio_outputs_count = (uint32_t)outBuffers.size();
+        p.in_events = &events.in;
+        p.out_events = &events.out;
+        auto res = plugin->process(plugin, &p);
+        steadyTime += blockSize;
+        events.clear();
+        return res;
+    }
+
+    double realTimeNsPerBlock() const { return 1e9 * blockSize / sampleRate; }
+};
+} // namespace sst::conduit::benchmarks
+
+#endif // CONDUIT_SRC_BENCHMARKS_BENCH_HOST_H
@@ -0,0 +1,100 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+/*
+ * A headless benchmark which loads every plugin through the clap factory and times
+ * process() at a fixed block size, with a simple repeating chord for the note consumers.
+ *
+ *    conduit-benchmark [--perf] [name-filter]
+ *
+ * --perf adds hardware counters for each measured region on linux.
+ */
+
+#include <cstdio>
+#include <string>
+
+#include <clap/entry.h>
+
+#include "bench-common.h"
+#include "bench-host.h"
+
+using namespace sst::conduit::benchmarks;
+
+int main(int argc, char **argv)
+{
+    auto opt = BenchOptions::fromArgs(argc, argv);
+
+    clap_entry.init(argv[0]);
+    auto f = static_cast<const clap_plugin_factory *>(clap_entry.get_factory(CLAP_PLUGIN_FACTORY_ID));
+
+    static constexpr double sampleRate{48000};
+    static constexpr uint32_t blockSize{256};
+    static constexpr uint64_t warmupBlocks{64}, measuredBlocks{4000};
+
+    printf("Conduit process benchmark: %.0f Hz, %u frame blocks, %llu blocks per plugin\n",
+           sampleRate, blockSize, (unsigned long long)measuredBlocks);
+
+    for (auto i = 0U; i < f->get_plugin_count(f); ++i)
+    {
+        auto desc = f->get_plugin_descriptor(f, i);
+        auto name = std::string("process/") + desc->id;
+        if (!opt.wants(name))
+            continue;
+
+        PluginRunner r(f, desc->id, sampleRate, blockSize);
+        if (!r.init() || !r.activate() || !r.startProcessing())
+        {
+            fprintf(stderr, "%s: failed to start\n", desc->id);
+            continue;
+        }
+
+        // Four note chord every 32 blocks, released after 16, so voices start and end
+        auto feed = [&r](uint64_t b) {
+            static constexpr int16_t chord[4]{48, 55, 60, 64};
+            if (b % 32 == 0)
+                for (auto k : chord)
+                    r.events.note(true, k + (b / 32) % 5);
+            if (b % 32 == 16)
+                for (auto k : chord)
+                    r.events.note(false, k + (b / 32) % 5);
+        };
+
+        for (uint64_t b = 0; b < warmupBlocks; ++b)
+        {
+            feed(b);
+            r.processBlock();
+        }
+
+        measure(
+            opt, name, measuredBlocks,
+            [&](uint64_t b) {
+                feed(b + warmupBlocks);
+                r.processBlock();
+            },
+            r.realTimeNsPerBlock());
+
+        r.stopProcessing();
+        r.deactivate();
+    }
+
+    clap_entry.deinit();
+    return 0;
+}
@@ -0,0 +1,305 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+/*
+ * Benchmarks for the main thread entry points hosts hammer while scanning, loading a
+ * project or drawing generic parameter UI, for every plugin in the clap factory:
+ *
+ * - per call cost of params info, value, value to text and text to value
+ * - per call cost of state save and state load
+ * - per call cost of create + init + destroy, and of activate + deactivate
+ * - the time, heap and resident memory to create, activate and destroy many instances
+ *
+ *    conduit-lifecycle-benchmark [--perf] [--instances N] [name-filter]
+ *
+ * --instances sets how many instances the many-instance run keeps alive at once, default
+ * 1000. Every instance is activated together, so resident memory peaks at roughly N times
+ * the activated footprint of the largest plugin (about 8MB for the polymetric delay, so
+ * around 8GB at the default); lower N on a smaller machine, or narrow the run with a name
+ * filter such as "instances/".
+ *
+ * This executable replaces the global operator new so every measurement also reports
+ * heap allocations. Over aligned allocations go through the default allocator and are
+ * not counted.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#include <clap/entry.h>
+
+#include "bench-common.h"
+#include "bench-host.h"
+
+using namespace sst::conduit::benchmarks;
+
+namespace
+{
+std::atomic<uint64_t> heapAllocations{0}, heapBytes{0};
+}
+
+void *operator new(std::size_t n)
+{
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    heapBytes.fetch_add(n, std::memory_order_relaxed);
+    if (auto p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void *operator new[](std::size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+static constexpr double sampleRate{48000};
+static constexpr uint32_t blockSize{256};
+
+// Resident set size in bytes, or -1 where we don't know how to ask
+static int64_t residentBytes()
+{
+#if defined(__linux__)
+    long pages{0}, resident{0};
+    auto f = fopen("/proc/self/statm", "r");
+    if (!f)
+        return -1;
+    auto ok = fscanf(f, "%ld %ld", &pages, &resident) == 2;
+    fclose(f);
+    return ok ? (int64_t)resident * sysconf(_SC_PAGESIZE) : -1;
+#else
+    return -1;
+#endif
+}
+
+static void benchParams(const BenchOptions &opt, const clap_plugin_factory *f, const char *id)
+{
+    PluginRunner r(f, id, sampleRate, blockSize);
+    if (!r.init())
+    {
+        fprintf(stderr, "%s: failed to init\n", id);
+        return;
+    }
+    auto p = r.plugin;
+    auto pe = static_cast<const clap_plugin_params *>(p->get_extension(p, CLAP_EXT_PARAMS));
+    if (!pe || pe->count(p) == 0)
+        return;
+
+    auto n = pe->count(p);
+    std::vector<clap_id> ids;
+    std::vector<double> values;
+    std::vector<std::string> texts;
+    for (auto i = 0U; i < n; ++i)
+    {
+        clap_param_info info{};
+        pe->get_info(p, i, &info);
+        double v{0};
+        pe->get_value(p, info.id, &v);
+        char buf[CLAP_NAME_SIZE]{};
+        if (!pe->value_to_text(p, info.id, v, buf, sizeof(buf)))
+            continue;
+        ids.push_back(info.id);
+        values.push_back(v);
+        texts.emplace_back(buf);
+    }
+    if (ids.empty())
+        return;
+
+    static constexpr uint64_t calls{100000};
+    auto sid = std::string("/") + id;
+
+    measure(opt, "params.info" + sid, calls, [&](uint64_t i) {
+        clap_param_info info;
+        pe->get_info(p, (uint32_t)(i % n), &info);
+    });
+    measure(opt, "params.value" + sid, calls, [&](uint64_t i) {
+        double v;
+        pe->get_value(p, ids[i % ids.size()], &v);
+    });
+    measure(opt, "params.value_to_text" + sid, calls, [&](uint64_t i) {
+        char buf[CLAP_NAME_SIZE];
+        auto k = i % ids.size();
+        pe->value_to_text(p, ids[k], values[k], buf, sizeof(buf));
+    });
+    measure(opt, "params.text_to_value" + sid, calls, [&](uint64_t i) {
+        double v;
+        auto k = i % ids.size();
+        pe->text_to_value(p, ids[k], texts[k].c_str(), &v);
+    });
+}
+
+static void benchState(const BenchOptions &opt, const clap_plugin_factory *f, const char *id)
+{
+    PluginRunner r(f, id, sampleRate, blockSize);
+    if (!r.init())
+        return;
+    auto p = r.plugin;
+    auto st = static_cast<const clap_plugin_state *>(p->get_extension(p, CLAP_EXT_STATE));
+    if (!st)
+        return;
+
+    static constexpr uint64_t calls{2000};
+    auto sid = std::string("/") + id;
+
+    StateBuffer sb;
+    measure(opt, "state.save" + sid, calls, [&](uint64_t) {
+        sb.clearForWrite();
+        st->save(p, &sb.os);
+    });
+    if (sb.data.empty())
+        return;
+
+    if (opt.wants("state.load" + sid))
+        printf("%-40s %12zu bytes\n", ("state.size" + sid).c_str(), sb.data.size());
+    measure(opt, "state.load" + sid, calls, [&](uint64_t) {
+        sb.rewind();
+        st->load(p, &sb.is);
+    });
+}
+
+static void benchSingleLifecycle(const BenchOptions &opt, const clap_plugin_factory *f,
+                                 const char *id)
+{
+    static constexpr uint64_t calls{200};
+    BenchHost bh;
+    auto sid = std::string("/") + id;
+
+    measure(opt, "create+init+destroy" + sid, calls, [&](uint64_t) {
+        auto p = f->create_plugin(f, &bh.host, id);
+        if (p)
+        {
+            p->init(p);
+            p->destroy(p);
+        }
+    });
+
+    PluginRunner r(f, id, sampleRate, blockSize);
+    if (!r.init())
+        return;
+    measure(opt, "activate+deactivate" + sid, calls, [&](uint64_t) {
+        if (r.activate())
+            r.deactivate();
+    });
+}
+
+/*
+ * The project load picture: lots of instances alive at once. Each phase reports wall
+ * time, heap allocations and bytes, and the change in resident memory, per instance.
+ */
+static void benchManyInstances(const BenchOptions &opt, const clap_plugin_factory *f,
+                               const char *id)
+{
+    auto name = std::string("instances/") + id;
+    if (!opt.wants(name))
+        return;
+
+    BenchHost bh;
+    std::vector<const clap_plugin *> plugins;
+    plugins.reserve(opt.instances);
+    int failures{0};
+
+    struct Mark
+    {
+        std::chrono::steady_clock::time_point t;
+        uint64_t allocs, bytes;
+        int64_t rss;
+    };
+    auto mark = []() {
+        return Mark{std::chrono::steady_clock::now(), heapAllocations.load(), heapBytes.load(),
+                    residentBytes()};
+    };
+    auto report = [&](const char *phase, const Mark &a, const Mark &b) {
+        auto ms = std::chrono::duration<double, std::milli>(b.t - a.t).count();
+        auto n = (double)opt.instances;
+        printf("%-40s %10.2f ms  %8.2f us/inst  allocs=%.1f/inst  heap=%.1fKB/inst",
+               (name + "/" + phase).c_str(), ms, 1000.0 * ms / n, (b.allocs - a.allocs) / n,
+               (b.bytes - a.bytes) / n / 1024.0);
+        if (a.rss >= 0 && b.rss >= 0)
+            printf("  rss=%+.1fMB", (b.rss - a.rss) / (1024.0 * 1024.0));
+        printf("\n");
+    };
+
+    auto m0 = mark();
+    for (int i = 0; i < opt.instances; ++i)
+    {
+        auto p = f->create_plugin(f, &bh.host, id);
+        if (p && p->init(p))
+        {
+            plugins.push_back(p);
+        }
+        else
+        {
+            if (p)
+                p->destroy(p);
+            failures++;
+        }
+    }
+    auto m1 = mark();
+    for (auto p : plugins)
+        if (!p->activate(p, sampleRate, 1, blockSize))
+            failures++;
+    auto m2 = mark();
+    for (auto p : plugins)
+        p->deactivate(p);
+    auto m3 = mark();
+    for (auto p : plugins)
+        p->destroy(p);
+    auto m4 = mark();
+
+    report("create+init", m0, m1);
+    report("activate", m1, m2);
+    report("deactivate", m2, m3);
+    report("destroy", m3, m4);
+    if (failures)
+        fprintf(stderr, "%s: %d failed create, init or activate calls\n", name.c_str(), failures);
+}
+
+int main(int argc, char **argv)
+{
+    auto opt = BenchOptions::fromArgs(argc, argv);
+    allocationCounter = &heapAllocations;
+
+    clap_entry.init(argv[0]);
+    auto f = static_cast<const clap_plugin_factory *>(clap_entry.get_factory(CLAP_PLUGIN_FACTORY_ID));
+
+    printf("Conduit main thread and lifecycle benchmark: %.0f Hz, %u frame blocks, %d instances\n",
+           sampleRate, blockSize, opt.instances);
+
+    for (auto i = 0U; i < f->get_plugin_count(f); ++i)
+    {
+        auto id = f->get_plugin_descriptor(f, i)->id;
+        benchParams(opt, f, id);
+        benchState(opt, f, id);
+        benchSingleLifecycle(opt, f, id);
+        benchManyInstances(opt, f, id);
+    }
+
+    clap_entry.deinit();
+    return 0;
+}
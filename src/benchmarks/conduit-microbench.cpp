@@ -0,0 +1,132 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+/*
+ * Microbenchmarks for individual DSP kernels, outside of any plugin process loop.
+ *
+ *    conduit-microbench [--perf] [name-filter]
+ *
+ * With --perf each kernel also reports cycles, instructions, cache and branch misses
+ * per iteration on linux, which is what tells a memory bound kernel from a compute
+ * bound one when we try layout changes.
+ */
+
+#include <cmath>
+#include <memory>
+#include <random>
+
+#include "bench-common.h"
+#include "bench-host.h"
+
+#include "polysynth/polysynth.h"
+#include "conduit-shared/int16-sinc-delay-line.h"
+#include "conduit-shared/envelope-rate-table.h"
+
+using namespace sst::conduit;
+using namespace sst::conduit::benchmarks;
+
+static constexpr double sampleRate{48000};
+
+// Four taps reading a long line at spread out, slowly moving delays, like the polymetric delay
+template <typename DL> void benchDelayLine(const BenchOptions &opt, const std::string &name)
+{
+    static constexpr size_t dlSize{1 << 20};
+    static constexpr uint64_t iterations{1 << 20};
+
+    sst::basic_blocks::tables::SurgeSincTableProvider st;
+    auto dl = std::make_unique<DL>(st);
+    for (size_t i = 0; i < dlSize; ++i)
+        dl->write(0.3f * std::sin(i * 0.001f));
+
+    static constexpr float taps[4]{4800.3f, 36000.7f, 180000.1f, 720000.9f};
+    float sink{0};
+    measure(
+        opt, name, iterations,
+        [&](uint64_t i) {
+            auto wob = 0.25f * (i & 1023) / 1024.f;
+            for (auto t : taps)
+                sink += dl->read(t + wob);
+            dl->write(sink * 1e-6f);
+        },
+        1e9 / sampleRate);
+    doNotOptimize(sink);
+}
+
+void benchVoices(const BenchOptions &opt)
+{
+    static constexpr uint64_t iterations{200000};
+
+    BenchHost bh;
+    auto synth = std::make_unique<polysynth::ConduitPolysynth>(&bh.host);
+    auto cp = synth->clapPlugin();
+    cp->init(cp);
+    cp->activate(cp, sampleRate, 1, 512);
+
+    for (int nVoices : {1, 8})
+    {
+        std::vector<std::unique_ptr<polysynth::PolysynthVoice>> vs;
+        for (int i = 0; i < nVoices; ++i)
+        {
+            auto v = std::make_unique<polysynth::PolysynthVoice>(*synth);
+            v->attachTo(*synth);
+            v->setSampleRate(sampleRate * 2);
+            v->start(0, 0, 48 + i * 3, -1, 0.8);
+            vs.push_back(std::move(v));
+        }
+
+        measure(
+            opt, "voice/processBlock x" + std::to_string(nVoices), iterations,
+            [&](uint64_t) {
+                for (auto &v : vs)
+                    v->processBlock();
+            },
+            1e9 * polysynth::PolysynthVoice::blockSize / sampleRate);
+    }
+
+    cp->deactivate(cp);
+}
+
+void benchEnvelopeRate(const BenchOptions &opt)
+{
+    static constexpr uint64_t iterations{1 << 22};
+    auto rt = shared::EnvelopeRateTable::forSampleRate(sampleRate);
+
+    measure(opt, "envelope/rate pow", iterations, [&](uint64_t i) {
+        auto f = -8.f + 16.f * (i & 4095) / 4096.f;
+        doNotOptimize(std::pow(2.f, -f) / sampleRate);
+    });
+    measure(opt, "envelope/rate table", iterations, [&](uint64_t i) {
+        auto f = -8.f + 16.f * (i & 4095) / 4096.f;
+        doNotOptimize(rt->rateLinear(f));
+    });
+}
+
+int main(int argc, char **argv)
+{
+    auto opt = BenchOptions::fromArgs(argc, argv);
+
+    benchDelayLine<sst::basic_blocks::dsp::SSESincDelayLine<1 << 20>>(opt, "delay/sinc read float");
+    benchDelayLine<shared::Int16SincDelayLine<1 << 20>>(opt, "delay/sinc read int16");
+    benchVoices(opt);
+    benchEnvelopeRate(opt);
+
+    return 0;
+}
@@ -0,0 +1,183 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_BENCHMARKS_PERF_COUNTERS_H
+#define CONDUIT_SRC_BENCHMARKS_PERF_COUNTERS_H
+
+/*
+ * Hardware counters for a measured region, using perf_event_open on linux. Each counter
+ * which the kernel lets us open joins one group so they all run over the same interval;
+ * anything unavailable (a VM without a PMU, a restrictive perf_event_paranoid) is just
+ * reported as missing. On other platforms open() returns false and nothing is counted.
+ */
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace sst::conduit::benchmarks
+{
+struct PerfCounters
+{
+    enum Counter
+    {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_READ_MISSES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+
+        nCounters
+    };
+    static constexpr std::array<const char *, nCounters> names{
+        "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"};
+
+    std::array<uint64_t, nCounters> values{};
+    std::array<bool, nCounters> available{};
+
+    PerfCounters() = default;
+    ~PerfCounters() { close(); }
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    bool open()
+    {
+#if defined(__linux__)
+        for (int c = 0; c < nCounters; ++c)
+        {
+            perf_event_attr pe;
+            memset(&pe, 0, sizeof(pe));
+            pe.size = sizeof(pe);
+            pe.disabled = leader < 0 ? 1 : 0;
+            pe.exclude_kernel = 1;
+            pe.exclude_hv = 1;
+            pe.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                             PERF_FORMAT_TOTAL_TIME_RUNNING;
+            configure(pe, (Counter)c);
+
+            auto fd = (int)syscall(SYS_perf_event_open, &pe, 0, -1, leader, 0);
+            if (fd < 0)
+                continue;
+            if (leader < 0)
+                leader = fd;
+            fds[c] = fd;
+            available[c] = true;
+            groupOrder[nOpen++] = c;
+        }
+        return leader >= 0;
+#else
+        return false;
+#endif
+    }
+
+    bool isOpen() const { return leader >= 0; }
+
+    void start()
+    {
+#if defined(__linux__)
+        if (leader < 0)
+            return;
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    void stop()
+    {
+#if defined(__linux__)
+        if (leader < 0)
+            return;
+        ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // nr, time enabled, time running, then one value per counter in open order
+        uint64_t buf[3 + nCounters]{};
+        if (read(leader, buf, sizeof(buf)) <= 0)
+            return;
+        auto enabled = buf[1], running = buf[2];
+        auto scale = running > 0 ? (double)enabled / running : 1.0;
+        for (uint64_t i = 0; i < buf[0] && i < (uint64_t)nOpen; ++i)
+            values[groupOrder[i]] = (uint64_t)(buf[3 + i] * scale);
+#endif
+    }
+
+    void close()
+    {
+#if defined(__linux__)
+        for (auto &fd : fds)
+        {
+            if (fd >= 0)
+                ::close(fd);
+            fd = -1;
+        }
+        leader = -1;
+        nOpen = 0;
+#endif
+    }
+
+  private:
+    int leader{-1};
+    std::array<int, nCounters> fds{-1, -1, -1, -1, -1};
+    std::array<int, nCounters> groupOrder{};
+    int nOpen{0};
+
+#if defined(__linux__)
+    static void configure(perf_event_attr &pe, Counter c)
+    {
+        switch (c)
+        {
+        case CYCLES:
+            pe.type = PERF_TYPE_HARDWARE;
+            pe.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case INSTRUCTIONS:
+            pe.type = PERF_TYPE_HARDWARE;
+            pe.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case L1D_READ_MISSES:
+            pe.type = PERF_TYPE_HW_CACHE;
+            pe.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case LLC_MISSES:
+            pe.type = PERF_TYPE_HARDWARE;
+            pe.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case BRANCH_MISSES:
+            pe.type = PERF_TYPE_HARDWARE;
+            pe.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        default:
+            break;
+        }
+    }
+#endif
+};
+} // namespace sst::conduit::benchmarks
+
+#endif // CONDUIT_SRC_BENCHMARKS_PERF_COUNTERS_H
@@ -20,7 +20,9 @@
  */
 
 #include "chord-memory.h"
+#if !defined(CONDUIT_HEADLESS)
 #include "juce_gui_basics/juce_gui_basics.h"
+#endif
 #include "version.h"
 
 namespace sst::conduit::chord_memory
@@ -62,8 +64,7 @@ ConduitChordMemory::ConduitChordMemory(const clap_host *host)
 
     attachParam(pmKeyShift, keyShift);
 
-    clapJuceShim = std::make_unique<sst::clap_juce_shim::ClapJuceShim>(this);
-    clapJuceShim->setResizable(true);
+    setupEditorShim(true);
 }
 
 ConduitChordMemory::~ConduitChordMemory() {}
@@ -94,21 +95,33 @@ bool ConduitChordMemory::notePortsInfo(uint32_t index, bool isInput,
 
 clap_process_status ConduitChordMemory::process(const clap_process *process) noexcept
 {
+    auto frBlock = flightRecorder.scopedBlock(process);
+    auto trBlock = traceScope("process");
+
     handleEventsFromUIQueue(process->out_events);
 
     auto ev = process->in_events;
     auto ov = process->out_events;
     auto sz = ev->size(ev);
 
+    // Chords are a pure function of the incoming notes, so nothing here needs time to
+    // pass. Sleep until the host has events (or a UI edit asks for a flush) for us.
     if (sz == 0)
-        return CLAP_PROCESS_CONTINUE;
+        return CLAP_PROCESS_SLEEP;
 
     // We know the input list is sorted
     for (auto i = 0U; i < sz; ++i)
     {
         auto evt = ev->get(ev, i);
 
-        if (handleParamBaseEvents(evt))
+        if (evt->space_id == CLAP_CORE_EVENT_SPACE_ID && evt->type == CLAP_EVENT_PARAM_MOD &&
+            reinterpret_cast<const clap_event_param_mod *>(evt)->param_id != pmKeyShift)
+        {
+            // Modulation for someone downstream, so pass it along to the parent and companions
+            ov->try_push(ov, evt);
+            fanOutToCompanions(ov, reinterpret_cast<const clap_event_param_mod *>(evt));
+        }
+        else if (handleParamBaseEvents(evt))
         {
         }
         else if (evt->space_id == CLAP_CORE_EVENT_SPACE_ID)
@@ -124,8 +137,9 @@ clap_process_status ConduitChordMemory::process(const clap_process *process) noe
 
                 if (msg == 0x90 || msg == 0x80)
                 {
+                    // A note on at velocity zero is a note off
                     handleMIDI1NoteChange(ov, mevt, chan, mevt->data[1], mevt->data[2] / 127.0,
-                                          msg == 0x90);
+                                          msg == 0x90 && mevt->data[2] > 0);
                     /*
                     clap_event_midi mextra;
                     memcpy(&mextra, mevt, sizeof(clap_event_midi));
@@ -149,6 +163,13 @@ clap_process_status ConduitChordMemory::process(const clap_process *process) noe
             }
             break;
 
+            case CLAP_EVENT_NOTE_EXPRESSION:
+            {
+                ov->try_push(ov, evt);
+                fanOutToCompanions(ov, reinterpret_cast<const clap_event_note_expression *>(evt));
+            }
+            break;
+
             default:
                 ov->try_push(ov, evt);
                 break;
@@ -160,44 +181,185 @@ clap_process_status ConduitChordMemory::process(const clap_process *process) noe
         }
     }
 
-    return CLAP_PROCESS_CONTINUE;
+    return CLAP_PROCESS_SLEEP;
 }
 
 void ConduitChordMemory::handleMIDI1NoteChange(const clap_output_events *ov,
                                                const clap_event_midi *mevt, int16_t channel,
                                                int16_t key, double vel, bool on)
 {
-    auto ks = (int)std::round(*keyShift);
-    auto nk = std::clamp(key + ks, 0, 127);
     if (updateNoteOnOffData(channel, key, on))
     {
         ov->try_push(ov, (const clap_event_header *)mevt);
     }
-    if (updateNoteOnOffData(channel, nk, on))
+
+    auto sendCompanion = [&](int16_t nk) {
+        if (updateNoteOnOffData(channel, nk, on))
+        {
+            clap_event_midi mextra;
+            memcpy(&mextra, mevt, sizeof(clap_event_midi));
+            mextra.data[1] = nk;
+            ov->try_push(ov, (const clap_event_header *)(&mextra));
+        }
+    };
+
+    // MIDI has no note ids, so the companions are tracked (and addressed) by key alone
+    if (on)
     {
-        clap_event_midi mextra;
-        memcpy(&mextra, mevt, sizeof(clap_event_midi));
-        mextra.data[1] = nk;
-        ov->try_push(ov, (const clap_event_header *)(&mextra));
+        auto nk = (int16_t)std::clamp(key + (int)std::round(*keyShift), 0, 127);
+        if (nk != key)
+        {
+            soundingNoteId[channel][nk] = -1;
+            sendCompanion(nk);
+        }
+        recordCompanions(mevt->port_index, channel, key, -1, nk);
+        return;
     }
+
+    std::array<int16_t, maxCompanionsPerNote> offKeys{};
+    auto nOff = takeCompanions(mevt->port_index, channel, key, -1, offKeys);
+    for (auto c = 0U; c < nOff; ++c)
+        sendCompanion(offKeys[c]);
 }
 
 void ConduitChordMemory::handleClapNoteChange(const clap_output_events *ov,
                                               const clap_event_note *nevt, int16_t channel,
                                               int16_t key, double vel, bool on)
 {
-    auto ks = (int)std::round(*keyShift);
-    auto nk = std::clamp(key + ks, 0, 127);
     if (updateNoteOnOffData(nevt->channel, nevt->key, on))
     {
+        if (on)
+            soundingNoteId[nevt->channel][nevt->key] = nevt->note_id;
         ov->try_push(ov, (const clap_event_header *)nevt);
     }
-    if (updateNoteOnOffData(nevt->channel, nk, on))
+
+    if (on)
+    {
+        auto ks = (int)std::round(*keyShift);
+        auto nk = (int16_t)std::clamp(key + ks, 0, 127);
+        // A shift of zero, or one clamped back onto the key, has no companion to play. Counting
+        // the key twice here would leave it held after the single release below.
+        if (nk != key && updateNoteOnOffData(nevt->channel, nk, on))
+        {
+            clap_event_note mextra = *nevt;
+            mextra.key = nk;
+            mextra.note_id = allocateCompanionNoteId();
+            soundingNoteId[nevt->channel][nk] = mextra.note_id;
+            ov->try_push(ov, (const clap_event_header *)(&mextra));
+        }
+
+        recordCompanions(nevt->port_index, nevt->channel, nevt->key, nevt->note_id, nk);
+        return;
+    }
+
+    std::array<int16_t, maxCompanionsPerNote> offKeys{};
+    auto nOff = takeCompanions(nevt->port_index, nevt->channel, nevt->key, nevt->note_id, offKeys);
+    for (auto c = 0U; c < nOff; ++c)
     {
-        clap_event_note mextra;
-        memcpy(&mextra, nevt, sizeof(clap_event_note));
-        mextra.key = nk;
-        ov->try_push(ov, (const clap_event_header *)(&mextra));
+        auto nk = offKeys[c];
+        if (updateNoteOnOffData(nevt->channel, nk, on))
+        {
+            clap_event_note mextra = *nevt;
+            mextra.key = nk;
+            mextra.note_id = soundingNoteId[nevt->channel][nk];
+            ov->try_push(ov, (const clap_event_header *)(&mextra));
+        }
+    }
+}
+
+void ConduitChordMemory::recordCompanions(int16_t port, int16_t channel, int16_t key,
+                                          int32_t parentNoteId, int16_t companionKey)
+{
+    if (nActiveMappings >= maxTrackedNotes)
+        return;
+
+    auto &m = companionMappings[nActiveMappings++];
+    m.port = port;
+    m.channel = channel;
+    m.key = key;
+    m.parentNoteId = parentNoteId;
+    m.nCompanions = 0;
+    if (companionKey != key)
+    {
+        // If the key was already sounding we address the note which is playing it
+        m.companionKey[m.nCompanions] = companionKey;
+        m.companionNoteId[m.nCompanions] = soundingNoteId[channel][companionKey];
+        m.nCompanions++;
+    }
+}
+
+uint32_t ConduitChordMemory::takeCompanions(int16_t port, int16_t channel, int16_t key,
+                                            int32_t noteId,
+                                            std::array<int16_t, maxCompanionsPerNote> &offKeys)
+{
+    // Release the companions we recorded at note on, so a key shift change in the
+    // middle of a note can't strand one. Fall back to the current shift if we lost track.
+    uint32_t nOff{0};
+    auto mi = findMapping(port, channel, key, noteId);
+    if (mi >= 0)
+    {
+        auto &m = companionMappings[mi];
+        for (auto c = 0U; c < m.nCompanions; ++c)
+            offKeys[nOff++] = m.companionKey[c];
+        m = companionMappings[--nActiveMappings];
+    }
+    else
+    {
+        auto nk = (int16_t)std::clamp(key + (int)std::round(*keyShift), 0, 127);
+        if (nk != key)
+            offKeys[nOff++] = nk;
+    }
+    return nOff;
+}
+
+int32_t ConduitChordMemory::allocateCompanionNoteId()
+{
+    auto res = nextCompanionNoteId;
+    nextCompanionNoteId =
+        (nextCompanionNoteId == INT32_MAX) ? firstCompanionNoteId : nextCompanionNoteId + 1;
+    return res;
+}
+
+int32_t ConduitChordMemory::findMapping(int16_t port, int16_t channel, int16_t key,
+                                        int32_t noteId, int32_t startAt) const
+{
+    for (auto i = (uint32_t)startAt; i < nActiveMappings; ++i)
+    {
+        const auto &m = companionMappings[i];
+        if (noteId != -1 && m.parentNoteId != -1)
+        {
+            if (m.parentNoteId == noteId)
+                return i;
+            continue;
+        }
+        if ((port == -1 || port == m.port) && (channel == -1 || channel == m.channel) &&
+            (key == -1 || key == m.key))
+            return i;
+    }
+    return -1;
+}
+
+template <typename E>
+void ConduitChordMemory::fanOutToCompanions(const clap_output_events *ov, const E *evt)
+{
+    // Fully wildcarded events already reach every note downstream, companions included
+    if (evt->note_id == -1 && evt->key == -1)
+        return;
+
+    auto mi = findMapping(evt->port_index, evt->channel, evt->key, evt->note_id);
+    while (mi >= 0)
+    {
+        const auto &m = companionMappings[mi];
+        for (auto c = 0U; c < m.nCompanions; ++c)
+        {
+            E copy = *evt;
+            copy.port_index = m.port;
+            copy.channel = m.channel;
+            copy.key = m.companionKey[c];
+            copy.note_id = m.companionNoteId[c];
+            ov->try_push(ov, &copy.header);
+        }
+        mi = findMapping(evt->port_index, evt->channel, evt->key, evt->note_id, mi + 1);
     }
 }
 
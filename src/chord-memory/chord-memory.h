@@ -100,7 +100,9 @@ struct ConduitChordMemory
     }
 
   protected:
+#if !defined(CONDUIT_HEADLESS)
     std::unique_ptr<juce::Component> createEditor() override;
+#endif
     std::atomic<bool> refreshUIValues{false};
 
     std::array<std::array<float, 128>, 16> activeNotes{};
@@ -115,9 +117,45 @@ struct ConduitChordMemory
     // If these return TRUE then you need to send a note on or off out.
     bool updateNoteOnOffData(int16_t channel, int16_t key, bool isOn);
 
+    /*
+     * Companion notes get their own note ids so a downstream synth can address them
+     * independently of the parent. Each sounding parent has an entry in this flat,
+     * preallocated table listing the ids we generated for it, and note expressions or
+     * polyphonic modulation aimed at the parent are copied to each companion. Notes
+     * which arrive as MIDI have no ids, so their entries match and address by key.
+     */
+    static constexpr uint32_t maxCompanionsPerNote{1}, maxTrackedNotes{512};
+    struct CompanionMapping
+    {
+        int16_t port{-1}, channel{-1}, key{-1};
+        int32_t parentNoteId{-1};
+        uint32_t nCompanions{0};
+        std::array<int16_t, maxCompanionsPerNote> companionKey{};
+        std::array<int32_t, maxCompanionsPerNote> companionNoteId{};
+    };
+    std::array<CompanionMapping, maxTrackedNotes> companionMappings{};
+    uint32_t nActiveMappings{0};
+
+    // The id of the note we actually sent for each channel and key, parent or companion
+    std::array<std::array<int32_t, 128>, 16> soundingNoteId{};
+
+    // Keep generated ids in the top of the positive range, away from typical host counters
+    static constexpr int32_t firstCompanionNoteId{0x40000000};
+    int32_t nextCompanionNoteId{firstCompanionNoteId};
+    int32_t allocateCompanionNoteId();
+
+    int32_t findMapping(int16_t port, int16_t channel, int16_t key, int32_t noteId,
+                        int32_t startAt = 0) const;
+    void recordCompanions(int16_t port, int16_t channel, int16_t key, int32_t parentNoteId,
+                          int16_t companionKey);
+    // Fills offKeys with the companions to release for this note and returns how many
+    uint32_t takeCompanions(int16_t port, int16_t channel, int16_t key, int32_t noteId,
+                            std::array<int16_t, maxCompanionsPerNote> &offKeys);
+    template <typename E> void fanOutToCompanions(const clap_output_events *ov, const E *evt);
+
   public:
     float *keyShift;
 };
 } // namespace sst::conduit::chord_memory
 
-#endif // CONDUIT_POLYMETRIC_DELAY_H
+#endif // CONDUIT_SRC_CHORD_MEMORY_CHORD_MEMORY_H
@@ -60,6 +60,7 @@ struct ConduitClapEventMonitorEditor : public sst::jucegui::accessibility::Ignor
             if (w)
             {
                 w->pullEvents();
+                w->pullTimings();
             }
         });
 
@@ -69,14 +70,27 @@ struct ConduitClapEventMonitorEditor : public sst::jucegui::accessibility::Ignor
         transportPanel = std::make_unique<jcmp::NamedPanel>("Transport");
         addAndMakeVisible(*transportPanel);
 
+        timingPanel = std::make_unique<jcmp::NamedPanel>("Host Timing");
+        addAndMakeVisible(*timingPanel);
+
         auto ep = std::make_unique<EventPainter>(*this);
         eventPainterWeak = ep.get();
         evtPanel->setContentAreaComponent(std::move(ep));
 
         auto tp = std::make_unique<TransportPainter>(this);
+        transportPainterWeak = tp.get();
         transportPanel->setContentAreaComponent(std::move(tp));
 
-        setSize(800, 700);
+        auto tmp = std::make_unique<TimingPainter>(*this);
+        timingPainterWeak = tmp.get();
+        timingPanel->setContentAreaComponent(std::move(tmp));
+
+        // Keep the panel chrome cached; the transport and list redraw only their own areas
+        evtPanel->setBufferedToImage(true);
+        transportPanel->setBufferedToImage(true);
+        timingPanel->setBufferedToImage(true);
+
+        setSize(800, 920);
     }
 
     ~ConduitClapEventMonitorEditor()
@@ -85,26 +99,23 @@ struct ConduitClapEventMonitorEditor : public sst::jucegui::accessibility::Ignor
         comms->stopProcessing();
     }
 
-    ConduitClapEventMonitorConfig::DataCopyForUI::evtCopy transportEvt;
+    ConduitClapEventMonitorConfig::DataCopyForUI::evtCopy transportEvt, scratchEvt;
 
     void pullEvents()
     {
         bool dorp{false};
-        while (!uic.dataCopyForUI.eventBuf.empty())
+        // These are a page each, so pop straight into place rather than in chunks
+        while (uic.dataCopyForUI.eventBuf.pop(scratchEvt))
         {
-            auto ib = uic.dataCopyForUI.eventBuf.pop();
-            if (ib.has_value())
+            if (scratchEvt.view()->space_id == CLAP_CORE_EVENT_SPACE_ID &&
+                scratchEvt.view()->type == CLAP_EVENT_TRANSPORT)
             {
-                if (ib->view()->space_id == CLAP_CORE_EVENT_SPACE_ID &&
-                    ib->view()->type == CLAP_EVENT_TRANSPORT)
-                {
-                    transportEvt = *ib;
-                    transportPanel->repaint();
-                }
-                else
-                {
-                    events.push_front(*ib);
-                }
+                transportEvt = scratchEvt;
+                transportPainterWeak->repaint();
+            }
+            else
+            {
+                events.push_front(scratchEvt);
             }
             dorp = true;
         }
@@ -112,6 +123,123 @@ struct ConduitClapEventMonitorEditor : public sst::jucegui::accessibility::Ignor
             eventPainterWeak->lb->updateContent();
     }
 
+    TimingAnalysis timing;
+    void pullTimings()
+    {
+        bool any{false};
+        std::array<BlockTiming, 256> chunk;
+        while (auto n = uic.dataCopyForUI.timingBuf.pop(chunk.data(), chunk.size()))
+        {
+            for (auto i = 0U; i < n; ++i)
+                timing.add(chunk[i], uic.dataCopyForUI.sampleRate);
+            any = true;
+        }
+        if (any)
+            timingPainterWeak->repaint();
+    }
+
+    struct TimingPainter : juce::Component
+    {
+        const ConduitClapEventMonitorEditor &editor;
+        TimingPainter(const ConduitClapEventMonitorEditor &e) : editor(e) {}
+
+        void paintHistogram(juce::Graphics &g, juce::Rectangle<int> r, const std::string &title,
+                            const TimingHistogram &h)
+        {
+            auto bins = std::vector<uint32_t>(h.bins.begin(), h.bins.end());
+            bins.insert(bins.begin(), h.under);
+            bins.push_back(h.over);
+            paintBars(g, r, title, bins, std::to_string((int)h.lo), std::to_string((int)h.hi));
+        }
+
+        void paintBars(juce::Graphics &g, juce::Rectangle<int> r, const std::string &title,
+                       const std::vector<uint32_t> &bins, const std::string &loLab,
+                       const std::string &hiLab)
+        {
+            g.setColour(juce::Colours::white);
+            g.drawText(title, r.removeFromTop(14), juce::Justification::centredLeft);
+            auto labels = r.removeFromBottom(12);
+            g.drawText(loLab, labels, juce::Justification::centredLeft);
+            g.drawText(hiLab, labels, juce::Justification::centredRight);
+
+            g.setColour(juce::Colour(0x20, 0x20, 0x30));
+            g.fillRect(r);
+
+            uint32_t mx{1};
+            for (auto b : bins)
+                mx = std::max(mx, b);
+            if (bins.empty())
+                return;
+            auto bw = 1.f * r.getWidth() / bins.size();
+            g.setColour(juce::Colour(0xFF, 0x90, 0x00));
+            for (auto i = 0U; i < bins.size(); ++i)
+            {
+                if (bins[i] == 0)
+                    continue;
+                // square root so the rare outliers we are looking for stay visible
+                auto bh = std::max(1.f, std::sqrt(1.f * bins[i] / mx) * r.getHeight());
+                g.fillRect(r.getX() + i * bw, r.getBottom() - bh, std::max(bw - 1, 1.f), bh);
+            }
+        }
+
+        void paint(juce::Graphics &g) override
+        {
+            const auto &t = editor.timing;
+            g.setFont(juce::Font(editor.fixedFace).withHeight(10));
+
+            if (t.blocks == 0)
+            {
+                g.setColour(juce::Colours::white);
+                g.drawText("Turn on 'Host Timing Analysis' to record process call timing",
+                           getLocalBounds(), juce::Justification::centred);
+                return;
+            }
+
+            auto b = getLocalBounds().reduced(4);
+            auto summary = b.removeFromBottom(42);
+            auto w = b.getWidth() / 4;
+
+            paintHistogram(g, b.removeFromLeft(w).reduced(3), "Interval Jitter (us)", t.jitterUs);
+
+            std::vector<uint32_t> sizes;
+            for (const auto &[f, n] : t.blockSizes)
+                sizes.push_back((uint32_t)std::min<uint64_t>(n, UINT32_MAX));
+            paintBars(g, b.removeFromLeft(w).reduced(3), "Block Sizes", sizes,
+                      std::to_string(t.blockSizes.begin()->first),
+                      std::to_string(t.blockSizes.rbegin()->first));
+
+            paintHistogram(g, b.removeFromLeft(w).reduced(3), "Deadline Headroom (ms)",
+                           t.headroomMs);
+            paintHistogram(g, b.reduced(3), "Transport Error (samples)",
+                           t.transportErrorSamples);
+
+            auto line = [&](const std::string &s) {
+                g.setColour(juce::Colours::white);
+                g.drawText(s, summary.removeFromTop(14), juce::Justification::centredLeft);
+            };
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(1) << "blocks=" << t.blocks
+                << " jitter mean=" << t.jitter.mean << "us sd=" << t.jitter.stddev()
+                << "us range=[" << t.jitter.lo << "," << t.jitter.hi << "]us";
+            line(oss.str());
+            oss.str("");
+            oss << std::fixed << std::setprecision(2) << "headroom min=" << t.headroom.lo
+                << "ms mean=" << t.headroom.mean << "ms late blocks=" << t.lateBlocks
+                << " block sizes=" << t.blockSizes.size();
+            line(oss.str());
+            oss.str("");
+            if (t.transportError.n == 0)
+                oss << "transport: no playing transport seen";
+            else
+                oss << std::fixed << std::setprecision(2)
+                    << "transport error sd=" << t.transportError.stddev()
+                    << "smp max=" << std::max(-t.transportError.lo, t.transportError.hi) << "smp";
+            oss << " discontinuities=" << t.transportDiscontinuities
+                << " event order errors=" << t.eventOrderErrors;
+            line(oss.str());
+        }
+    };
+
     struct TransportPainter : juce::Component
     {
         ConduitClapEventMonitorEditor *editor;
@@ -179,6 +307,13 @@ struct ConduitClapEventMonitorEditor : public sst::jucegui::accessibility::Ignor
             F(IS_WITHIN_PRE_ROLL);
 
 #undef A
+
+            auto &dc = editor->uic.dataCopyForUI;
+            if (dc.streamOpen)
+            {
+                g.drawText(std::string("Streaming to shm ") + dc.streamName, 0, getHeight() - 20,
+                           getWidth(), 20, juce::Justification::centredRight);
+            }
         }
     };
 
@@ -344,15 +479,19 @@ struct ConduitClapEventMonitorEditor : public sst::jucegui::accessibility::Ignor
 
     void resized() override
     {
-        auto spl = 180;
+        auto spl = 180, tspl = 220;
         if (evtPanel)
-            evtPanel->setBounds(getLocalBounds().withTrimmedTop(spl));
+            evtPanel->setBounds(getLocalBounds().withTrimmedTop(spl + tspl));
         if (transportPanel)
             transportPanel->setBounds(getLocalBounds().withHeight(spl));
+        if (timingPanel)
+            timingPanel->setBounds(getLocalBounds().withTrimmedTop(spl).withHeight(tspl));
     }
-    std::unique_ptr<jcmp::NamedPanel> evtPanel, transportPanel;
+    std::unique_ptr<jcmp::NamedPanel> evtPanel, transportPanel, timingPanel;
     std::deque<ConduitClapEventMonitorConfig::DataCopyForUI::evtCopy> events;
     EventPainter *eventPainterWeak{nullptr};
+    TransportPainter *transportPainterWeak{nullptr};
+    TimingPainter *timingPainterWeak{nullptr};
     juce::Typeface::Ptr fixedFace{nullptr};
 };
 } // namespace sst::conduit::clap_event_monitor::editor
@@ -20,9 +20,13 @@
  */
 
 #include "clap-event-monitor.h"
+#if !defined(CONDUIT_HEADLESS)
 #include "juce_gui_basics/juce_gui_basics.h"
+#endif
 #include "version.h"
 
+#include <chrono>
+
 namespace sst::conduit::clap_event_monitor
 {
 const clap_plugin_descriptor *ConduitClapEventMonitorConfig::getDescription()
@@ -75,13 +79,72 @@ ConduitClapEventMonitor::ConduitClapEventMonitor(const clap_host *host)
                                     .withGroupName("Monitor")
                                     .withFlags(modFlag));
 
+    paramDescriptions.push_back(ParamDesc()
+                                    .asBool()
+                                    .withID(pmStreamToShm)
+                                    .withName("Stream Events To Shared Memory")
+                                    .withGroupName("Monitor")
+                                    .withFlags(CLAP_PARAM_IS_STEPPED));
+
+    paramDescriptions.push_back(ParamDesc()
+                                    .asBool()
+                                    .withID(pmTimingAnalysis)
+                                    .withName("Host Timing Analysis")
+                                    .withGroupName("Monitor")
+                                    .withFlags(CLAP_PARAM_IS_STEPPED));
+
     configureParams();
 
-    clapJuceShim = std::make_unique<sst::clap_juce_shim::ClapJuceShim>(this);
-    clapJuceShim->setResizable(true);
+    attachParam(pmStreamToShm, streamToShm);
+    attachParam(pmTimingAnalysis, timingAnalysis);
+
+    setupEditorShim(true);
 }
 
-ConduitClapEventMonitor::~ConduitClapEventMonitor() {}
+ConduitClapEventMonitor::~ConduitClapEventMonitor() { closeEventStream(); }
+
+bool ConduitClapEventMonitor::openEventStream()
+{
+    auto &dc = uiComms.dataCopyForUI;
+    if (eventStream.isOpen())
+        return true;
+
+    if (!eventStream.open(sampleRate))
+    {
+        CNDOUT << "Unable to open shared memory event stream" << std::endl;
+        return false;
+    }
+
+    strncpy(dc.streamName, eventStream.segmentName().c_str(), sizeof(dc.streamName) - 1);
+    dc.streamOpen = true;
+    dc.updateCount++;
+    CNDOUT << "Streaming events to shared memory " << eventStream.segmentName() << std::endl;
+    return true;
+}
+
+void ConduitClapEventMonitor::closeEventStream()
+{
+    auto &dc = uiComms.dataCopyForUI;
+    if (!eventStream.isOpen())
+        return;
+
+    eventStream.close();
+    dc.streamOpen = false;
+    dc.updateCount++;
+}
+
+void ConduitClapEventMonitor::onMainThread() noexcept
+{
+    // Creating the segment allocates and touches the file system so process asks for it here.
+    // A failed open leaves the request set so we don't retry every block until deactivate.
+    if (eventStreamOpenRequested)
+    {
+        auto wanted = *streamToShm > 0.5;
+        if (!wanted || (isActive() && openEventStream()))
+            eventStreamOpenRequested = false;
+    }
+    ClapBaseClass<ConduitClapEventMonitor, ConduitClapEventMonitorConfig>::onMainThread();
+}
 
 bool ConduitClapEventMonitor::audioPortsInfo(uint32_t index, bool isInput,
                                              clap_audio_port_info *info) const noexcept
@@ -115,8 +178,56 @@ bool ConduitClapEventMonitor::notePortsInfo(uint32_t index, bool isInput,
             CLAP_NAME_SIZE - 1);
     return true;
 }
+/*
+ * Called first thing in process so the arrival time is as close to the host's call as we
+ * can get. The analysis itself runs in the editor; see timing-analysis.h
+ */
+void ConduitClapEventMonitor::recordBlockTiming(const clap_process *process, uint64_t arrivalNs)
+{
+    BlockTiming bt;
+    bt.arrivalNs = arrivalNs;
+    bt.frames = process->frames_count;
+
+    auto ev = process->in_events;
+    bt.eventCount = ev->size(ev);
+    uint32_t lastTime{0};
+    for (auto i = 0U; i < bt.eventCount; ++i)
+    {
+        auto t = ev->get(ev, i)->time;
+        if (t < lastTime || t >= process->frames_count)
+            bt.eventOrderErrors++;
+        lastTime = std::max(lastTime, t);
+    }
+
+    if (auto tr = process->transport)
+    {
+        bt.playing = tr->flags & CLAP_TRANSPORT_IS_PLAYING;
+        if (tr->flags & CLAP_TRANSPORT_HAS_SECONDS_TIMELINE)
+        {
+            bt.hasTransport = true;
+            bt.songPosSeconds = 1.0 * tr->song_pos_seconds / CLAP_SECTIME_FACTOR;
+        }
+        else if ((tr->flags & CLAP_TRANSPORT_HAS_BEATS_TIMELINE) &&
+                 (tr->flags & CLAP_TRANSPORT_HAS_TEMPO) && tr->tempo > 0)
+        {
+            bt.hasTransport = true;
+            bt.songPosSeconds = 60.0 * tr->song_pos_beats / CLAP_BEATTIME_FACTOR / tr->tempo;
+        }
+    }
+    uiComms.dataCopyForUI.timingBuf.push(bt);
+}
+
 clap_process_status ConduitClapEventMonitor::process(const clap_process *process) noexcept
 {
+    auto arrivalNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                         std::chrono::steady_clock::now().time_since_epoch())
+                         .count();
+    auto frBlock = flightRecorder.scopedBlock(process);
+    auto trBlock = traceScope("process");
+
+    if (*timingAnalysis > 0.5)
+        recordBlockTiming(process, arrivalNs);
+
     auto ev = process->in_events;
     auto ov = process->out_events;
     auto sz = ev->size(ev);
@@ -130,15 +241,49 @@ clap_process_status ConduitClapEventMonitor::process(const clap_process *process
     {
         samplePos = 0;
     }
+
+    // The segment is only unmapped at deactivate, so turning the param off just stops writes
+    auto streaming = *streamToShm > 0.5;
+    if (streaming && !eventStream.isOpen() && !eventStreamOpenRequested)
+    {
+        eventStreamOpenRequested = true;
+        _host.requestCallback();
+    }
+    if (streaming)
+    {
+        eventStream.beginBlock(streamSamplePos, process->frames_count);
+        if (process->transport)
+            eventStream.write((const clap_event_header_t *)process->transport);
+    }
+    streamSamplePos += process->frames_count;
+
     for (auto i = 0U; i < sz; ++i)
     {
         auto et = ev->get(ev, i);
         uiComms.dataCopyForUI.writeEventTo(et);
+        if (streaming)
+            eventStream.write(et);
+
+        // We only own two parameters which matter; the rest are just here to be monitored
+        if (et->space_id == CLAP_CORE_EVENT_SPACE_ID && et->type == CLAP_EVENT_PARAM_VALUE)
+        {
+            auto pid = reinterpret_cast<const clap_event_param_value *>(et)->param_id;
+            if (pid == pmStreamToShm || pid == pmTimingAnalysis)
+                handleParamBaseEvents(et);
+        }
 
         ov->try_push(ov, et);
     }
 
-    return CLAP_PROCESS_CONTINUE;
+    // Timing analysis and the shm stream want every block, and a running transport changes
+    // without any event telling us. Otherwise there's nothing to show until an event arrives.
+    auto playing = process->transport && (process->transport->flags & CLAP_TRANSPORT_IS_PLAYING);
+    if (sz > 0 || streaming || *timingAnalysis > 0.5 || playing)
+        return CLAP_PROCESS_CONTINUE;
+
+    // Force a transport copy on wake so the display catches up straight away
+    samplePos = 0;
+    return CLAP_PROCESS_SLEEP;
 }
 
 } // namespace sst::conduit::clap_event_monitor
@@ -30,13 +30,15 @@
 
 #include <memory>
 #include "sst/basic-blocks/params/ParamMetadata.h"
-#include "sst/cpputils/ring_buffer.h"
+#include "conduit-shared/spsc-queue.h"
 
 #include "conduit-shared/clap-base-class.h"
+#include "shm-event-stream.h"
+#include "timing-analysis.h"
 
 namespace sst::conduit::clap_event_monitor
 {
-static constexpr int nParams = 3;
+static constexpr int nParams = 5;
 
 struct ConduitClapEventMonitorConfig
 {
@@ -50,6 +52,10 @@ struct ConduitClapEventMonitorConfig
         std::atomic<bool> isProcessing{false};
 
         std::atomic<uint64_t> processedSamples{0};
+
+        // Set on the main thread once the shared memory stream is live
+        std::atomic<bool> streamOpen{false};
+        char streamName[64]{};
         static constexpr uint32_t maxEventSize{4096}, maxEvents{4096};
 
         struct evtCopy
@@ -66,7 +72,7 @@ struct ConduitClapEventMonitorConfig
                 return reinterpret_cast<const clap_event_header_t *>(data);
             }
         };
-        sst::cpputils::SimpleRingBuffer<evtCopy, 4096> eventBuf;
+        sst::conduit::shared::SPSCQueue<evtCopy, 4096> eventBuf;
 
         unsigned char eventData[maxEventSize * maxEvents];
         void writeEventTo(const clap_event_header_t *e)
@@ -76,6 +82,10 @@ struct ConduitClapEventMonitorConfig
             eventBuf.push(ec);
         }
 
+        // One per process call while timing analysis is on. See timing-analysis.h
+        sst::conduit::shared::SPSCQueue<BlockTiming, 4096> timingBuf;
+        std::atomic<double> sampleRate{0};
+
         // Read happens ui thread. Might be corrupted. Big queue. Copy soon.
         const clap_event_header_t *readEventFrom(int idx)
         {
@@ -96,15 +106,38 @@ struct ConduitClapEventMonitor
                   uint32_t maxFrameCount) noexcept override
     {
         setSampleRate(sampleRate);
+        uiComms.dataCopyForUI.sampleRate = sampleRate;
+        if (*streamToShm > 0.5)
+            openEventStream();
         return true;
     }
 
+    void deactivate() noexcept override
+    {
+        closeEventStream();
+        eventStreamOpenRequested = false;
+
+        // With no editor draining them the rings fill up and stay resident; the editor
+        // pops on this (main) thread so nothing is mid read while we drop them
+        if (releaseDSPMemory())
+        {
+            auto &d = uiComms.dataCopyForUI;
+            d.eventBuf.clear();
+            d.timingBuf.clear();
+            shared::DSPArena::discardRange(d.eventBuf.storage(), d.eventBuf.storageBytes);
+            shared::DSPArena::discardRange(d.timingBuf.storage(), d.timingBuf.storageBytes);
+        }
+    }
+
     enum paramIds : uint32_t
     {
         pmStepped = 24842,
 
         pmAuto = 912,
-        pmMod = 2112
+        pmMod = 2112,
+
+        pmStreamToShm = 3377,
+        pmTimingAnalysis = 3378
     };
 
     bool implementsAudioPorts() const noexcept override { return true; }
@@ -139,12 +172,25 @@ struct ConduitClapEventMonitor
 
     typedef std::unordered_map<int, int> PatchPluginExtension;
 
+    void onMainThread() noexcept override;
+
   protected:
+#if !defined(CONDUIT_HEADLESS)
     std::unique_ptr<juce::Component> createEditor() override;
+#endif
     std::atomic<bool> refreshUIValues{false};
 
-    uint64_t samplePos{0};
+    uint64_t samplePos{0}, streamSamplePos{0};
+
+    float *streamToShm{nullptr};
+    float *timingAnalysis{nullptr};
+    void recordBlockTiming(const clap_process *process, uint64_t arrivalNs);
+
+    shm::EventStreamWriter eventStream;
+    std::atomic<bool> eventStreamOpenRequested{false};
+    bool openEventStream();
+    void closeEventStream();
 };
 } // namespace sst::conduit::clap_event_monitor
 
-#endif // CONDUIT_POLYMETRIC_DELAY_H
+#endif // CONDUIT_SRC_CLAP_EVENT_MONITOR_CLAP_EVENT_MONITOR_H
@@ -0,0 +1,159 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+/*
+ * A small reference reader for the event monitor shared memory stream. Run it with the
+ * segment name the monitor prints (or shows in its transport panel) and it follows the
+ * ring, printing each event along with the wall clock spacing of the host's process calls.
+ * It maps the segment read only and never writes to it, so it cannot disturb the plugin.
+ */
+
+#include <cstdio>
+#include <cinttypes>
+#include <thread>
+#include <chrono>
+
+#include "shm-event-stream.h"
+
+using namespace sst::conduit::clap_event_monitor::shm;
+
+static const char *eventTypeName(uint16_t t)
+{
+    switch (t)
+    {
+    case CLAP_EVENT_NOTE_ON:
+        return "NOTE_ON";
+    case CLAP_EVENT_NOTE_OFF:
+        return "NOTE_OFF";
+    case CLAP_EVENT_NOTE_CHOKE:
+        return "NOTE_CHOKE";
+    case CLAP_EVENT_NOTE_END:
+        return "NOTE_END";
+    case CLAP_EVENT_NOTE_EXPRESSION:
+        return "NOTE_EXPRESSION";
+    case CLAP_EVENT_PARAM_VALUE:
+        return "PARAM_VALUE";
+    case CLAP_EVENT_PARAM_MOD:
+        return "PARAM_MOD";
+    case CLAP_EVENT_PARAM_GESTURE_BEGIN:
+        return "PARAM_GESTURE_BEGIN";
+    case CLAP_EVENT_PARAM_GESTURE_END:
+        return "PARAM_GESTURE_END";
+    case CLAP_EVENT_TRANSPORT:
+        return "TRANSPORT";
+    case CLAP_EVENT_MIDI:
+        return "MIDI";
+    case CLAP_EVENT_MIDI_SYSEX:
+        return "MIDI_SYSEX";
+    case CLAP_EVENT_MIDI2:
+        return "MIDI2";
+    }
+    return "UNKNOWN";
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Usage: %s /conduit-evmon-<pid>-<n>\n", argv[0]);
+        return 1;
+    }
+
+    auto fd = shm_open(argv[1], O_RDONLY, 0);
+    if (fd < 0)
+    {
+        perror("shm_open");
+        return 2;
+    }
+    auto mem = mmap(nullptr, segmentSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED)
+    {
+        perror("mmap");
+        return 2;
+    }
+
+    auto h = static_cast<const StreamHeader *>(mem);
+    if (h->magic != streamMagic || h->version != streamVersion || h->slotCount != slotCount ||
+        h->slotEventBytes != slotEventBytes)
+    {
+        fprintf(stderr, "%s is not a version %u conduit event stream\n", argv[1], streamVersion);
+        return 3;
+    }
+    printf("Attached to %s from pid %" PRIu64 " at %.1f Hz\n", argv[1], h->writerPid,
+           h->sampleRate);
+
+    auto slots = slotsFor(h);
+    uint64_t next = h->writeSequence.load(std::memory_order_acquire);
+    uint64_t lastBlockPos{UINT64_MAX}, lastBlockNs{0};
+    StreamSlot copy;
+
+    while (true)
+    {
+        auto published = h->writeSequence.load(std::memory_order_acquire);
+        if (published - next > slotCount)
+        {
+            printf("-- reader overrun, skipped %" PRIu64 " events\n", published - next - slotCount);
+            next = published - slotCount;
+        }
+
+        while (next < published)
+        {
+            auto &s = slots[next & (slotCount - 1)];
+            auto s1 = s.sequence.load(std::memory_order_acquire);
+            copy.blockSamplePosition = s.blockSamplePosition;
+            copy.blockWallClockNs = s.blockWallClockNs;
+            copy.blockFrames = s.blockFrames;
+            copy.eventBytes = s.eventBytes;
+            memcpy(copy.event, s.event, slotEventBytes);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            auto s2 = s.sequence.load(std::memory_order_relaxed);
+
+            if (s1 != s2 || s1 != 2 * next + 2)
+            {
+                // The writer lapped us while we were copying; resync on the next pass
+                break;
+            }
+
+            if (copy.blockSamplePosition != lastBlockPos)
+            {
+                auto expectedUs = 1e6 * copy.blockFrames / h->sampleRate;
+                if (lastBlockNs != 0)
+                {
+                    auto actualUs = (copy.blockWallClockNs - lastBlockNs) / 1000.0;
+                    printf("block @%" PRIu64 " frames=%u since last=%.1fus (block is %.1fus)\n",
+                           copy.blockSamplePosition, copy.blockFrames, actualUs, expectedUs);
+                }
+                lastBlockPos = copy.blockSamplePosition;
+                lastBlockNs = copy.blockWallClockNs;
+            }
+
+            auto e = copy.view();
+            printf("  %8" PRIu64 " t=%-4u space=%-3u %-20s size=%u%s\n", next, e->time,
+                   e->space_id, e->space_id == CLAP_CORE_EVENT_SPACE_ID ? eventTypeName(e->type)
+                                                                        : "",
+                   copy.eventBytes, copy.truncated() ? " (truncated)" : "");
+            ++next;
+        }
+        fflush(stdout);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
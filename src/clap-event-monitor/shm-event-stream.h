@@ -0,0 +1,230 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_CLAP_EVENT_MONITOR_SHM_EVENT_STREAM_H
+#define CONDUIT_SRC_CLAP_EVENT_MONITOR_SHM_EVENT_STREAM_H
+
+/*
+ * The event monitor can optionally mirror every event it sees into a named
+ * POSIX shared memory segment so tools outside the host can watch the live
+ * stream. The segment is a header followed by a power-of-two ring of fixed
+ * size slots. There is exactly one writer (the audio thread) and it never
+ * waits on anything; readers map the segment read-only and use the per-slot
+ * sequence number as a seqlock to detect torn or overwritten slots. A slow
+ * reader just loses events, it can never hold up the plugin.
+ *
+ * This header is shared by the plugin and by event-stream-reader.cpp so keep
+ * it free of plugin dependencies beyond the clap event header.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <new>
+
+#include <clap/events.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONDUIT_HAS_SHM_EVENT_STREAM 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define CONDUIT_HAS_SHM_EVENT_STREAM 0
+#endif
+
+namespace sst::conduit::clap_event_monitor::shm
+{
+static constexpr uint32_t streamMagic{0x436e4576}; // 'CnEv'
+static constexpr uint32_t streamVersion{1};
+static constexpr uint32_t slotCount{8192};
+static constexpr uint32_t slotEventBytes{224};
+static_assert((slotCount & (slotCount - 1)) == 0, "slotCount must be a power of two");
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "The stream needs address-free atomics to work across processes");
+
+struct alignas(64) StreamHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotEventBytes;
+    double sampleRate;
+    uint64_t writerPid;
+
+    // Total number of slots ever published. Slot n lives at n & (slotCount - 1).
+    alignas(64) std::atomic<uint64_t> writeSequence;
+};
+
+struct alignas(64) StreamSlot
+{
+    // 2n+1 while event n is being written, 2n+2 once it is complete
+    std::atomic<uint64_t> sequence;
+
+    uint64_t blockSamplePosition; // samples processed before the block carrying this event
+    uint64_t blockWallClockNs;    // steady clock at the start of that block
+    uint32_t blockFrames;
+    uint32_t eventBytes; // full size of the event; only slotEventBytes are kept
+    unsigned char event[slotEventBytes];
+
+    const clap_event_header_t *view() const
+    {
+        return reinterpret_cast<const clap_event_header_t *>(event);
+    }
+    bool truncated() const { return eventBytes > slotEventBytes; }
+};
+static_assert(sizeof(StreamSlot) == 256);
+
+static constexpr size_t segmentSize{sizeof(StreamHeader) + sizeof(StreamSlot) * slotCount};
+
+inline StreamSlot *slotsFor(StreamHeader *h)
+{
+    return reinterpret_cast<StreamSlot *>(reinterpret_cast<unsigned char *>(h) +
+                                          sizeof(StreamHeader));
+}
+inline const StreamSlot *slotsFor(const StreamHeader *h)
+{
+    return reinterpret_cast<const StreamSlot *>(reinterpret_cast<const unsigned char *>(h) +
+                                                sizeof(StreamHeader));
+}
+
+inline uint64_t steadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/*
+ * Owned by the plugin. open and close run on the main thread; close must only
+ * be called when the audio thread cannot be in process (deactivate or destruction).
+ * beginBlock and write are audio thread only and are a no-op when not open.
+ */
+struct EventStreamWriter
+{
+    EventStreamWriter() = default;
+    ~EventStreamWriter() { close(); }
+    EventStreamWriter(const EventStreamWriter &) = delete;
+    EventStreamWriter &operator=(const EventStreamWriter &) = delete;
+
+    bool open(double sampleRate)
+    {
+#if CONDUIT_HAS_SHM_EVENT_STREAM
+        if (header.load(std::memory_order_acquire))
+            return true;
+
+        static std::atomic<uint32_t> instanceCounter{0};
+        name = "/conduit-evmon-" + std::to_string(getpid()) + "-" +
+               std::to_string(instanceCounter++);
+
+        auto fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0)
+            return false;
+        if (ftruncate(fd, segmentSize) != 0)
+        {
+            ::close(fd);
+            shm_unlink(name.c_str());
+            return false;
+        }
+        auto mem = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mem == MAP_FAILED)
+        {
+            shm_unlink(name.c_str());
+            return false;
+        }
+
+        // ftruncate zero fills, so every slot sequence starts at 0, which no event uses
+        auto h = new (mem) StreamHeader();
+        h->magic = streamMagic;
+        h->version = streamVersion;
+        h->slotCount = slotCount;
+        h->slotEventBytes = slotEventBytes;
+        h->sampleRate = sampleRate;
+        h->writerPid = (uint64_t)getpid();
+        h->writeSequence.store(0, std::memory_order_relaxed);
+        for (uint32_t i = 0; i < slotCount; ++i)
+            new (&slotsFor(h)[i]) StreamSlot();
+
+        header.store(h, std::memory_order_release);
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void close()
+    {
+#if CONDUIT_HAS_SHM_EVENT_STREAM
+        auto h = header.exchange(nullptr);
+        if (h)
+        {
+            munmap(h, segmentSize);
+            shm_unlink(name.c_str());
+        }
+#endif
+    }
+
+    bool isOpen() const { return header.load(std::memory_order_acquire) != nullptr; }
+    const std::string &segmentName() const { return name; }
+
+    void beginBlock(uint64_t samplePosition, uint32_t frames)
+    {
+        blockSamplePosition = samplePosition;
+        blockFrames = frames;
+        blockWallClockNs = steadyNowNs();
+    }
+
+    void write(const clap_event_header_t *e)
+    {
+        auto h = header.load(std::memory_order_acquire);
+        if (!h)
+            return;
+
+        auto n = h->writeSequence.load(std::memory_order_relaxed);
+        auto &slot = slotsFor(h)[n & (slotCount - 1)];
+
+        slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.blockSamplePosition = blockSamplePosition;
+        slot.blockWallClockNs = blockWallClockNs;
+        slot.blockFrames = blockFrames;
+        slot.eventBytes = e->size;
+        memcpy(slot.event, e, std::min(e->size, slotEventBytes));
+
+        slot.sequence.store(2 * n + 2, std::memory_order_release);
+        h->writeSequence.store(n + 1, std::memory_order_release);
+    }
+
+  private:
+    std::atomic<StreamHeader *> header{nullptr};
+    std::string name;
+
+    uint64_t blockSamplePosition{0}, blockWallClockNs{0};
+    uint32_t blockFrames{0};
+};
+} // namespace sst::conduit::clap_event_monitor::shm
+
+#endif // CONDUIT_SRC_CLAP_EVENT_MONITOR_SHM_EVENT_STREAM_H
@@ -0,0 +1,180 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_CLAP_EVENT_MONITOR_TIMING_ANALYSIS_H
+#define CONDUIT_SRC_CLAP_EVENT_MONITOR_TIMING_ANALYSIS_H
+
+/*
+ * With timing analysis on, the audio thread writes one BlockTiming per process call into a
+ * ring: when the call arrived, how big it was, where the transport said it was and whether
+ * its events were in order. Nothing else happens on the audio thread. The editor drains the
+ * ring into a TimingAnalysis, which keeps the histograms and summaries it draws:
+ *
+ * - interval jitter: the time since the previous call less the time that call's frames cover
+ * - block sizes: how often each frames_count was used
+ * - deadline headroom: a block's own duration less how late it arrived against the schedule
+ *   implied by the samples so far, anchored at the earliest arrival seen. Clock drift
+ *   between the device and the system clock shows up here as a slow trend.
+ * - transport error: how far the song position moved, in samples, against the frames of
+ *   the previous block while playing. Larger jumps count as discontinuities (loops, seeks).
+ */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+
+namespace sst::conduit::clap_event_monitor
+{
+struct BlockTiming
+{
+    uint64_t arrivalNs{0};
+    uint32_t frames{0};
+    uint32_t eventCount{0};
+    uint32_t eventOrderErrors{0}; // events earlier than the one before, or past the block end
+    bool hasTransport{false}, playing{false};
+    double songPosSeconds{0}; // from the seconds timeline, or the beats one over tempo
+};
+
+struct TimingHistogram
+{
+    static constexpr int nBins{48};
+    float lo, hi;
+    std::array<uint32_t, nBins> bins{};
+    uint32_t under{0}, over{0};
+
+    TimingHistogram(float l, float h) : lo(l), hi(h) {}
+
+    void add(float v)
+    {
+        if (v < lo)
+            under++;
+        else if (v >= hi)
+            over++;
+        else
+            bins[std::clamp((int)((v - lo) / (hi - lo) * nBins), 0, nBins - 1)]++;
+    }
+    uint32_t maxCount() const
+    {
+        return std::max({*std::max_element(bins.begin(), bins.end()), under, over});
+    }
+    void reset()
+    {
+        bins = {};
+        under = 0;
+        over = 0;
+    }
+};
+
+struct RunningStats
+{
+    uint64_t n{0};
+    double mean{0}, m2{0};
+    double lo{std::numeric_limits<double>::max()}, hi{std::numeric_limits<double>::lowest()};
+
+    void add(double v)
+    {
+        n++;
+        auto d = v - mean;
+        mean += d / n;
+        m2 += d * (v - mean);
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+    }
+    double stddev() const { return n > 1 ? std::sqrt(m2 / (n - 1)) : 0.0; }
+};
+
+struct TimingAnalysis
+{
+    // Records further apart than this mean the analysis was off, so start again
+    static constexpr double restartGapSeconds{0.5};
+
+    TimingHistogram jitterUs{-1000.f, 1000.f};
+    TimingHistogram headroomMs{-5.f, 20.f};
+    TimingHistogram transportErrorSamples{-16.f, 16.f};
+    std::map<uint32_t, uint64_t> blockSizes;
+
+    RunningStats jitter, headroom, transportError;
+    uint64_t blocks{0}, eventOrderErrors{0}, transportDiscontinuities{0}, lateBlocks{0};
+
+    void reset() { *this = TimingAnalysis(); }
+
+    void add(const BlockTiming &b, double sampleRate)
+    {
+        if (sampleRate <= 0)
+            return;
+
+        if (blocks > 0 && (b.arrivalNs < prior.arrivalNs ||
+                           (b.arrivalNs - prior.arrivalNs) * 1e-9 > restartGapSeconds))
+            reset();
+
+        blocks++;
+        blockSizes[b.frames]++;
+        eventOrderErrors += b.eventOrderErrors;
+
+        auto blockSeconds = b.frames / sampleRate;
+        auto scheduleNs = b.arrivalNs - 1e9 * samplesSoFar / sampleRate;
+        if (blocks == 1 || scheduleNs < anchorNs)
+            anchorNs = scheduleNs;
+        auto lateMs = (scheduleNs - anchorNs) * 1e-6;
+        auto hr = blockSeconds * 1e3 - lateMs;
+        headroomMs.add(hr);
+        headroom.add(hr);
+        if (hr < 0)
+            lateBlocks++;
+
+        if (blocks > 1)
+        {
+            auto intervalUs = (b.arrivalNs - prior.arrivalNs) * 1e-3;
+            auto j = intervalUs - 1e6 * prior.frames / sampleRate;
+            jitterUs.add(j);
+            jitter.add(j);
+
+            if (b.hasTransport && prior.hasTransport && b.playing && prior.playing)
+            {
+                auto moved = (b.songPosSeconds - prior.songPosSeconds) * sampleRate;
+                auto err = moved - prior.frames;
+                if (std::fabs(err) > std::max(prior.frames, 1U))
+                {
+                    transportDiscontinuities++;
+                }
+                else
+                {
+                    transportErrorSamples.add(err);
+                    transportError.add(err);
+                }
+            }
+        }
+
+        samplesSoFar += b.frames;
+        prior = b;
+    }
+
+  private:
+    BlockTiming prior;
+    uint64_t samplesSoFar{0};
+    double anchorNs{0};
+};
+} // namespace sst::conduit::clap_event_monitor
+
+#endif // CONDUIT_SRC_CLAP_EVENT_MONITOR_TIMING_ANALYSIS_H
@@ -55,7 +55,7 @@
 namespace sst::conduit::pluginentry
 {
 
-uint32_t clap_get_plugin_count(const clap_plugin_factory *f) { return 8; }
+uint32_t clap_get_plugin_count(const clap_plugin_factory *f) { return 10; }
 const clap_plugin_descriptor *clap_get_plugin_descriptor(const clap_plugin_factory *f, uint32_t w)
 {
     if (w == 0)
@@ -75,6 +75,12 @@ const clap_plugin_descriptor *clap_get_plugin_descriptor(const clap_plugin_facto
     if (w == 7)
         return multiout_synth::ConduitMultiOutSynthConfig::getDescription();
 
+    // Lighter configurations of the plugins above, sharing their sources and patches
+    if (w == 8)
+        return polysynth_lite::getDescription();
+    if (w == 9)
+        return polymetric_delay::ConduitPolymetricDelayConfig::getShortDescription();
+
     CNDOUT << "Clap Plugin not found at " << w << std::endl;
     return nullptr;
 }
@@ -128,6 +134,17 @@ static const clap_plugin *clap_create_plugin(const clap_plugin_factory *f, const
         auto p = new multiout_synth::ConduitMultiOutSynth(host);
         return p->clapPlugin();
     }
+
+    // Lite is a separate build of the polysynth sources; see polysynth/variant.h
+    if (strcmp(plugin_id, polysynth_lite::getDescription()->id) == 0)
+        return polysynth_lite::create(host);
+
+    if (strcmp(plugin_id,
+               polymetric_delay::ConduitPolymetricDelayConfig::getShortDescription()->id) == 0)
+    {
+        auto p = new polymetric_delay::ConduitPolymetricDelay(host, true);
+        return p->clapPlugin();
+    }
     CNDOUT << "No plugin found; returning nullptr" << std::endl;
     return nullptr;
 }
@@ -185,6 +202,19 @@ static bool clap_get_auv2_info(const clap_plugin_factory_as_auv2 *factory, uint3
         strncpy(info->au_subt, "mlOs", 5);
         return true;
     }
+
+    if (strcmp(plugin_id, polysynth_lite::getDescription()->id) == 0)
+    {
+        strncpy(info->au_subt, "PlyL", 5);
+        return true;
+    }
+
+    if (strcmp(plugin_id,
+               polymetric_delay::ConduitPolymetricDelayConfig::getShortDescription()->id) == 0)
+    {
+        strncpy(info->au_subt, "dLy4", 5);
+        return true;
+    }
     return false;
 }
 
@@ -0,0 +1,245 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_CONDUIT_SHARED_ADAA_H
+#define CONDUIT_SRC_CONDUIT_SHARED_ADAA_H
+
+/*
+ * Antiderivative anti-aliasing for memoryless nonlinearities, four lanes at a time.
+ *
+ * Rather than evaluate f at each sample, first order ADAA outputs the average of f over
+ * the straight line between this input and the last, (F1(x) - F1(x1)) / (x - x1), which
+ * is a built in lowpass on the harmonics f generates. Second order averages that again
+ * using F2, the antiderivative of F1. The cost is half a sample (first order) or a
+ * sample (second order) of delay and a little top end droop, in exchange for around 8dB
+ * (first order) or 12dB (second order) less aliasing on a hard driven high sine at 1x.
+ *
+ * Each shape supplies f, F1 and F2 in closed form, written branchless over the lanes.
+ * When successive inputs get too close the divided differences cancel catastrophically
+ * in float, so those lanes fall back to f or F1 at the midpoint, which is the limit.
+ */
+
+#include "sse-include.h"
+
+namespace sst::conduit::shared::adaa
+{
+inline __m128 select(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+inline __m128 abs(__m128 x) { return _mm_andnot_ps(_mm_set1_ps(-0.f), x); }
+// +-1 with the sign of x, so odd functions can be built from their positive half
+inline __m128 sign(__m128 x)
+{
+    return _mm_or_ps(_mm_and_ps(_mm_set1_ps(-0.f), x), _mm_set1_ps(1.f));
+}
+inline __m128 small(__m128 d, float eps) { return _mm_cmplt_ps(abs(d), _mm_set1_ps(eps)); }
+
+// clamp to +-1
+struct HardClip
+{
+    static __m128 f(__m128 x)
+    {
+        return _mm_max_ps(_mm_min_ps(x, _mm_set1_ps(1.f)), _mm_set1_ps(-1.f));
+    }
+    static __m128 F1(__m128 x)
+    {
+        auto in = _mm_cmple_ps(abs(x), _mm_set1_ps(1.f));
+        auto inside = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_mul_ps(x, x));
+        auto outside = _mm_sub_ps(abs(x), _mm_set1_ps(0.5f));
+        return select(in, inside, outside);
+    }
+    static __m128 F2(__m128 x)
+    {
+        auto in = _mm_cmple_ps(abs(x), _mm_set1_ps(1.f));
+        auto x2 = _mm_mul_ps(x, x);
+        auto inside = _mm_mul_ps(_mm_set1_ps(1.f / 6.f), _mm_mul_ps(x2, x));
+        auto outside = _mm_sub_ps(
+            _mm_mul_ps(sign(x), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x2),
+                                           _mm_set1_ps(1.f / 6.f))),
+            _mm_mul_ps(_mm_set1_ps(0.5f), x));
+        return select(in, inside, outside);
+    }
+};
+
+// 1.5x - 0.5x^3 inside +-1 and flat outside; unity gain at the top and smooth at the knee
+struct CubicSoftClip
+{
+    static __m128 f(__m128 x)
+    {
+        auto c = HardClip::f(x);
+        auto c3 = _mm_mul_ps(c, _mm_mul_ps(c, c));
+        return _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(1.5f), c), _mm_mul_ps(_mm_set1_ps(0.5f), c3));
+    }
+    static __m128 F1(__m128 x)
+    {
+        auto in = _mm_cmple_ps(abs(x), _mm_set1_ps(1.f));
+        auto x2 = _mm_mul_ps(x, x);
+        auto inside = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(0.75f), x2),
+                                 _mm_mul_ps(_mm_set1_ps(0.125f), _mm_mul_ps(x2, x2)));
+        auto outside = _mm_sub_ps(abs(x), _mm_set1_ps(0.375f));
+        return select(in, inside, outside);
+    }
+    static __m128 F2(__m128 x)
+    {
+        auto in = _mm_cmple_ps(abs(x), _mm_set1_ps(1.f));
+        auto x2 = _mm_mul_ps(x, x);
+        auto x3 = _mm_mul_ps(x2, x);
+        auto inside = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(0.25f), x3),
+                                 _mm_mul_ps(_mm_set1_ps(0.025f), _mm_mul_ps(x3, x2)));
+        auto outside = _mm_sub_ps(
+            _mm_mul_ps(sign(x), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x2), _mm_set1_ps(0.1f))),
+            _mm_mul_ps(_mm_set1_ps(0.375f), x));
+        return select(in, inside, outside);
+    }
+};
+
+// |x|
+struct Rectifier
+{
+    static __m128 f(__m128 x) { return abs(x); }
+    static __m128 F1(__m128 x) { return _mm_mul_ps(_mm_set1_ps(0.5f), _mm_mul_ps(x, abs(x))); }
+    static __m128 F2(__m128 x)
+    {
+        auto a = abs(x);
+        return _mm_mul_ps(_mm_set1_ps(1.f / 6.f), _mm_mul_ps(a, _mm_mul_ps(a, a)));
+    }
+};
+
+/*
+ * The ring modulator's diode pair, d(x) + d(-x) for the single diode curve d which is off
+ * below vb, quadratic up to vl and linear with unit slope above. Since d(x) is zero for
+ * x < 0 the pair is just d(|x|), so F1 is odd and F2 even in the single diode integrals.
+ */
+struct DiodePair
+{
+    static constexpr float vb{0.2f}, vl{0.5f}, w{vl - vb};
+
+    static __m128 f(__m128 x)
+    {
+        auto a = abs(x);
+        auto u = _mm_max_ps(_mm_sub_ps(a, _mm_set1_ps(vb)), _mm_setzero_ps());
+        auto knee = _mm_mul_ps(_mm_set1_ps(0.5f / w), _mm_mul_ps(u, u));
+        auto lin = _mm_sub_ps(a, _mm_set1_ps(0.5f * (vl + vb)));
+        return select(_mm_cmplt_ps(a, _mm_set1_ps(vl)), knee, lin);
+    }
+    static __m128 F1(__m128 x)
+    {
+        auto a = abs(x);
+        auto u = _mm_max_ps(_mm_sub_ps(a, _mm_set1_ps(vb)), _mm_setzero_ps());
+        auto knee = _mm_mul_ps(_mm_set1_ps(1.f / (6.f * w)), _mm_mul_ps(u, _mm_mul_ps(u, u)));
+        auto v = _mm_sub_ps(a, _mm_set1_ps(vl));
+        auto lin = _mm_add_ps(
+            _mm_set1_ps(w * w / 6.f),
+            _mm_mul_ps(v, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.5f), v), _mm_set1_ps(0.5f * w))));
+        return _mm_mul_ps(sign(x), select(_mm_cmplt_ps(a, _mm_set1_ps(vl)), knee, lin));
+    }
+    static __m128 F2(__m128 x)
+    {
+        auto a = abs(x);
+        auto u = _mm_max_ps(_mm_sub_ps(a, _mm_set1_ps(vb)), _mm_setzero_ps());
+        auto u2 = _mm_mul_ps(u, u);
+        auto knee = _mm_mul_ps(_mm_set1_ps(1.f / (24.f * w)), _mm_mul_ps(u2, u2));
+        auto v = _mm_sub_ps(a, _mm_set1_ps(vl));
+        auto v2 = _mm_mul_ps(v, v);
+        auto lin = _mm_add_ps(
+            _mm_add_ps(_mm_set1_ps(w * w * w / 24.f), _mm_mul_ps(_mm_set1_ps(w * w / 6.f), v)),
+            _mm_mul_ps(v2, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(1.f / 6.f), v),
+                                      _mm_set1_ps(0.25f * w))));
+        return select(_mm_cmplt_ps(a, _mm_set1_ps(vl)), knee, lin);
+    }
+};
+
+template <typename Shape> struct FirstOrder
+{
+    static constexpr float eps{1e-3f};
+
+    __m128 x1{_mm_setzero_ps()}, F1x1{_mm_setzero_ps()};
+
+    void reset()
+    {
+        x1 = _mm_setzero_ps();
+        F1x1 = Shape::F1(x1);
+    }
+
+    __m128 process(__m128 x)
+    {
+        auto F1x = Shape::F1(x);
+        auto d = _mm_sub_ps(x, x1);
+        auto slope = _mm_div_ps(_mm_sub_ps(F1x, F1x1), d);
+        auto mid = Shape::f(_mm_mul_ps(_mm_set1_ps(0.5f), _mm_add_ps(x, x1)));
+        x1 = x;
+        F1x1 = F1x;
+        return select(small(d, eps), mid, slope);
+    }
+};
+
+template <typename Shape> struct SecondOrder
+{
+    // The second difference divides twice so needs a wider band before falling back
+    static constexpr float eps{1e-2f}, epsSecond{1e-1f};
+
+    __m128 x1{_mm_setzero_ps()}, x2{_mm_setzero_ps()};
+    __m128 F2x1{_mm_setzero_ps()}, D1prev{_mm_setzero_ps()};
+
+    void reset()
+    {
+        x1 = _mm_setzero_ps();
+        x2 = _mm_setzero_ps();
+        F2x1 = Shape::F2(x1);
+        D1prev = Shape::F1(x1);
+    }
+
+    __m128 process(__m128 x)
+    {
+        const auto half = _mm_set1_ps(0.5f);
+        const auto two = _mm_set1_ps(2.f);
+
+        // First divided difference of F2 between this input and the last, which is F1 there
+        auto F2x = Shape::F2(x);
+        auto d = _mm_sub_ps(x, x1);
+        auto D1 = select(small(d, eps), Shape::F1(_mm_mul_ps(half, _mm_add_ps(x, x1))),
+                         _mm_div_ps(_mm_sub_ps(F2x, F2x1), d));
+
+        // ... and the second, across x, x1, x2
+        auto d2 = _mm_sub_ps(x, x2);
+        auto full = _mm_div_ps(_mm_mul_ps(two, _mm_sub_ps(D1, D1prev)), d2);
+
+        // With x ~ x2 integrate from the middle of the pair out to x1 instead
+        auto xb = _mm_mul_ps(half, _mm_add_ps(x, x2));
+        auto delta = _mm_sub_ps(xb, x1);
+        auto F1xb = Shape::F1(xb);
+        auto F2xb = Shape::F2(xb);
+        auto edge = _mm_div_ps(
+            _mm_mul_ps(two, _mm_add_ps(F1xb, _mm_div_ps(_mm_sub_ps(F2x1, F2xb), delta))), delta);
+        auto centre = Shape::f(_mm_mul_ps(half, _mm_add_ps(xb, x1)));
+        auto close = select(small(delta, eps), centre, edge);
+
+        x2 = x1;
+        x1 = x;
+        F2x1 = F2x;
+        D1prev = D1;
+        return select(small(d2, epsSecond), close, full);
+    }
+};
+} // namespace sst::conduit::shared::adaa
+
+#endif // CONDUIT_SRC_CONDUIT_SHARED_ADAA_H
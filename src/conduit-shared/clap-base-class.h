@@ -22,7 +22,11 @@
 #ifndef CONDUIT_SRC_CONDUIT_SHARED_CLAP_BASE_CLASS_H
 #define CONDUIT_SRC_CONDUIT_SHARED_CLAP_BASE_CLASS_H
 
+#include <array>
+#include <atomic>
 #include <cstdint>
+#include <cstdlib>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 #include <type_traits>
@@ -35,7 +39,6 @@
 #include <clap/helpers/plugin.hh>
 #include <clap/ext/state.h>
 
-#include "sst/cpputils/ring_buffer.h"
 #include "sst/basic-blocks/dsp/Lag.h"
 #include "sst/basic-blocks/tables/DbToLinearProvider.h"
 #include "sst/basic-blocks/tables/EqualTuningProvider.h"
@@ -46,8 +49,17 @@
 #include <clapwrapper/vst3.h>
 
 #include <sst/basic-blocks/params/ParamMetadata.h>
+#if !defined(CONDUIT_HEADLESS)
 #include <sst/clap_juce_shim/clap_juce_shim.h>
+#endif
 #include "debug-helpers.h"
+#include "envelope-rate-table.h"
+#include "flight-recorder.h"
+#include "trace-recorder.h"
+#include "local-tuning.h"
+#include "dsp-arena.h"
+#include "spsc-queue.h"
+#include "table-cache.h"
 
 namespace sst::conduit::shared
 {
@@ -62,27 +74,48 @@ struct EmptyPatchExtension
     static constexpr bool hasExtension{false};
 };
 
+/*
+ * With CONDUIT_HEADLESS the plugins build without JUCE or any editor code. The editor
+ * boundary is the EditorProvider, so here we drop it and the shim, implementsGui reports
+ * false and isEditorAttached is always false; the plugins use those two and
+ * setupEditorShim and never touch the shim directly.
+ */
 template <typename T, typename TConfig>
+#if defined(CONDUIT_HEADLESS)
+struct ClapBaseClass : public plugHelper_t
+#else
 struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
+#endif
 {
     using config_t = TConfig;
 
     ClapBaseClass(const clap_host *host)
         : plugHelper_t(TConfig::getDescription(), host), uiComms(*this)
     {
-        dbToLinearTable.init();
-        equalTuningTable.init();
-        twoToXTable.init();
         guaranteeDocumentsPath();
+        flightRecorder.configure(TConfig::getDescription()->id, documentsPath);
+        flightRecorder.watchQueue(uiComms.toUiQ);
+        flightRecorder.watchQueue(uiComms.fromUiQ);
+        setupTracing(TConfig::getDescription()->name);
+        resetAudioPortActivation();
     }
 
     ClapBaseClass(const clap_plugin_descriptor *desc, const clap_host *host)
         : plugHelper_t(desc, host), uiComms(*this)
     {
-        dbToLinearTable.init();
-        equalTuningTable.init();
-        twoToXTable.init();
         guaranteeDocumentsPath();
+        flightRecorder.configure(desc->id, documentsPath);
+        flightRecorder.watchQueue(uiComms.toUiQ);
+        flightRecorder.watchQueue(uiComms.fromUiQ);
+        setupTracing(desc->name);
+        resetAudioPortActivation();
+    }
+
+    ~ClapBaseClass()
+    {
+        if (instanceLocked)
+            DSPArena::unlockRange(static_cast<T *>(this), sizeof(T));
+        TraceRecorder::get().unregisterInstance(traceInstance);
     }
 
     // Most things are sample accurate, but some have a slow- or block- based approach.
@@ -93,9 +126,16 @@ struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
     std::vector<ParamDesc> paramDescriptions;
     std::unordered_map<uint32_t, ParamDesc> paramDescriptionMap;
 
-    sst::basic_blocks::tables::DbToLinearProvider dbToLinearTable;
-    sst::basic_blocks::tables::EqualTuningProvider equalTuningTable;
-    sst::basic_blocks::tables::TwoToTheXProvider twoToXTable;
+    // Shared by every instance, and mapped from disk where possible. See table-cache.h
+    const sst::basic_blocks::tables::DbToLinearProvider &dbToLinearTable{
+        TableCache::get<sst::basic_blocks::tables::DbToLinearProvider>(
+            "db-to-linear", [](auto &t) { t.init(); })};
+    const sst::basic_blocks::tables::EqualTuningProvider &equalTuningTable{
+        TableCache::get<sst::basic_blocks::tables::EqualTuningProvider>(
+            "equal-tuning", [](auto &t) { t.init(); })};
+    const sst::basic_blocks::tables::TwoToTheXProvider &twoToXTable{
+        TableCache::get<sst::basic_blocks::tables::TwoToTheXProvider>(
+            "two-to-the-x", [](auto &t) { t.init(); })};
 
 #define cbassert(x, y)                                                                             \
     {                                                                                              \
@@ -309,6 +349,7 @@ struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
     bool implementsState() const noexcept override { return true; }
     bool stateSave(const clap_ostream *ostream) noexcept override
     {
+        auto tr = traceScope("state save");
         TiXmlDocument document;
 
         TiXmlElement conduit("conduit");
@@ -326,6 +367,18 @@ struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
         }
         conduit.InsertEndChild(paramel);
 
+        if (keepMemoryWhileInactive)
+            conduit.SetAttribute("keepMemoryWhileInactive", 1);
+
+        if (streamedTuning &&
+            (!streamedTuning->sclText.empty() || !streamedTuning->kbmText.empty()))
+        {
+            TiXmlElement tun("tuning");
+            tun.SetAttribute("scl", streamedTuning->sclText);
+            tun.SetAttribute("kbm", streamedTuning->kbmText);
+            conduit.InsertEndChild(tun);
+        }
+
         if constexpr (TConfig::PatchExtension::hasExtension)
         {
             TiXmlElement ext("extension");
@@ -355,6 +408,7 @@ struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
     }
     bool stateLoad(const clap_istream *istream) noexcept override
     {
+        auto tr = traceScope("state load");
         static constexpr uint32_t maxSize = 1 << 16, chunkSize = 1 << 8;
         char buffer[maxSize];
         char *bp = &(buffer[0]);
@@ -498,6 +552,23 @@ struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
             }
         }
 
+        int keepMemory{0};
+        conduit->QueryIntAttribute("keepMemoryWhileInactive", &keepMemory);
+        keepMemoryWhileInactive = keepMemory != 0;
+
+        if (streamedTuning)
+        {
+            // A state without a tuning element is 12-TET
+            std::string scl, kbm;
+            auto tun = TINYXML_SAFE_TO_ELEMENT(conduit->FirstChild("tuning"));
+            if (tun)
+            {
+                tun->QueryStringAttribute("scl", &scl);
+                tun->QueryStringAttribute("kbm", &kbm);
+            }
+            streamedTuning->setScaleAndMapping(scl, kbm);
+        }
+
         if (TConfig::baseClassProvidesMonoModSupport)
         {
             monoModulatedPatch.updateAll(patch);
@@ -510,18 +581,96 @@ struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
 
     // Sample Rate Support
     double sampleRate{0}, sampleRateInv{0}, dsamplerate_inv{0}, samplerate{0};
+    const EnvelopeRateTable *envelopeRates{nullptr};
     void setSampleRate(double sr)
     {
         sampleRate = sr;
         samplerate = sr;
         sampleRateInv = 1.0 / sr;
         dsamplerate_inv = sampleRateInv; // just an alis
+        envelopeRates = EnvelopeRateTable::forSampleRate(sr);
+        flightRecorder.sampleRate = sr;
+    }
+
+    // Plugins wrap their process in flightRecorder.scopedBlock(process); off until asked for
+    FlightRecorder flightRecorder;
+
+    /*
+     * Timeline tracing is process wide, see trace-recorder.h. Each instance gets its own row
+     * in the trace, and plugins mark process and their larger stages with a traceScope.
+     */
+    uint32_t traceInstance{TraceRecorder::sharedInstance};
+    TraceScope traceScope(const char *name) const { return {name, traceInstance}; }
+    void setupTracing(const char *name)
+    {
+        auto &tr = TraceRecorder::get();
+        traceInstance = tr.registerInstance(name);
+        if (std::getenv("CONDUIT_TRACE") && !TraceRecorder::isTracing())
+            tr.start(documentsPath / "Traces");
+    }
+
+    // Plugins with a LocalTuning point this at it so the scale and mapping are streamed
+    LocalTuning *streamedTuning{nullptr};
+
+    // Large audio thread state is built in here at activate. See dsp-arena.h
+    DSPArena dspArena;
+
+    /*
+     * Call at the end of activate once the DSP state is built. Faults in every page of the
+     * instance and its arena here on the main thread rather than in the first blocks which
+     * use them, and with CONDUIT_LOCK_DSP_MEMORY locks them into RAM too. Failing to lock
+     * (usually RLIMIT_MEMLOCK) is logged but not fatal.
+     */
+    void prefaultDSPMemory()
+    {
+        auto self = static_cast<T *>(this);
+        DSPArena::prefaultRange(self, sizeof(T));
+        dspArena.prefault();
+#if defined(CONDUIT_LOCK_DSP_MEMORY)
+        if (!instanceLocked)
+            instanceLocked = DSPArena::lockRange(self, sizeof(T));
+        if (!instanceLocked || !dspArena.lock())
+            CNDOUT << "Unable to lock " << sizeof(T) + dspArena.bytesUsed()
+                   << " bytes of DSP memory; continuing unlocked" << std::endl;
+#endif
     }
+    bool instanceLocked{false};
 
+    /*
+     * The other half, for deactivate: release the arena and unlock the instance so its
+     * pages can go too. Returns false, doing nothing, when the instance is set to keep its
+     * memory for an instant resume; otherwise the caller should also discard any large
+     * inline buffers (DSPArena::discardRange) and drop its pointers into the arena.
+     */
+    bool releaseDSPMemory()
+    {
+        if (keepMemoryWhileInactive)
+            return false;
+        if (instanceLocked)
+            DSPArena::unlockRange(static_cast<T *>(this), sizeof(T));
+        instanceLocked = false;
+        dspArena.release();
+        return true;
+    }
+    // Per instance and streamed with the state
+    std::atomic<bool> keepMemoryWhileInactive{false};
+
+#if defined(CONDUIT_HEADLESS)
+    bool implementsGui() const noexcept override { return false; }
+    bool isEditorAttached() const { return false; }
+    void setupEditorShim(bool resizable) {}
+#else
     bool implementsGui() const noexcept override { return clapJuceShim != nullptr; }
+    bool isEditorAttached() const { return clapJuceShim && clapJuceShim->isEditorAttached(); }
+    void setupEditorShim(bool resizable)
+    {
+        clapJuceShim = std::make_unique<sst::clap_juce_shim::ClapJuceShim>(this);
+        clapJuceShim->setResizable(resizable);
+    }
     std::unique_ptr<sst::clap_juce_shim::ClapJuceShim> clapJuceShim;
     ADD_SHIM_IMPLEMENTATION(clapJuceShim)
     ADD_SHIM_LINUX_TIMER(clapJuceShim)
+#endif
 
     struct ToUI
     {
@@ -590,7 +739,7 @@ struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
             try
             {
                 std::filesystem::path fsp{pointerToPath};
-                delete pointerToPath;
+                free(pointerToPath); // the editor mallocs these; see EditorBase
 
                 if (operation == SAVE)
                 {
@@ -677,8 +826,8 @@ struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
     struct UICommunicationBundle
     {
         UICommunicationBundle(ClapBaseClass<T, TConfig> &h) : cp(h) {}
-        typedef sst::cpputils::SimpleRingBuffer<ToUI, 4096> SynthToUI_Queue_t;
-        typedef sst::cpputils::SimpleRingBuffer<FromUI, 4096> UIToSynth_Queue_t;
+        typedef SPSCQueue<ToUI, 4096> SynthToUI_Queue_t;
+        typedef SPSCQueue<FromUI, 4096> UIToSynth_Queue_t;
 
         SynthToUI_Queue_t toUiQ;
         UIToSynth_Queue_t fromUiQ;
@@ -720,6 +869,29 @@ struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
 
         std::filesystem::path getDocumentsPath() const { return cp.documentsPath; }
 
+        float getFlightRecorderTrigger() const { return cp.flightRecorder.getTriggerFraction(); }
+        void setFlightRecorderTrigger(float f) { cp.flightRecorder.setTriggerFraction(f); }
+
+        LocalTuning *getLocalTuning() const { return cp.streamedTuning; }
+
+        bool getKeepMemoryWhileInactive() const { return cp.keepMemoryWhileInactive; }
+        void setKeepMemoryWhileInactive(bool k)
+        {
+            cp.keepMemoryWhileInactive = k;
+            if (cp._host.canUseState())
+                cp._host.stateMarkDirty();
+        }
+
+        uint32_t getTraceInstance() const { return cp.traceInstance; }
+        bool isTracing() const { return TraceRecorder::isTracing(); }
+        void setTracing(bool t)
+        {
+            if (t)
+                TraceRecorder::get().start(cp.documentsPath / "Traces");
+            else
+                TraceRecorder::get().stop();
+        }
+
       private:
         // Used to be const but I want to save and load from the UI thread
         // so make it private and only do that internally
@@ -788,19 +960,30 @@ struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
         }
     }
 
-    uint32_t handleEventsFromUIQueue(const clap_output_events_t *ov)
+    // Drains the UI queue in chunks; small enough to sit on the audio thread stack
+    static constexpr size_t fromUIChunkSize{64};
+    template <typename F> uint32_t drainFromUIQueue(F &&onMessage)
     {
-        uint32_t adjustedCount{0};
-        while (!uiComms.fromUiQ.empty())
+        uint32_t count{0};
+        std::array<FromUI, fromUIChunkSize> chunk;
+        while (auto n = uiComms.fromUiQ.pop(chunk.data(), chunk.size()))
         {
-            auto r = *uiComms.fromUiQ.pop();
-            adjustedCount++;
+            for (auto i = 0U; i < n; ++i)
+                onMessage(chunk[i]);
+            count += n;
+        }
+        return count;
+    }
+
+    uint32_t handleEventsFromUIQueue(const clap_output_events_t *ov)
+    {
+        auto adjustedCount = drainFromUIQueue([this, ov](const FromUI &r) {
             generateOutputMessagesFromUI(r, ov);
             if (r.type == FromUI::ADJUST_VALUE)
             {
                 doValueUpdate(r.id, r.value);
             }
-        }
+        });
         refreshUIIfNeeded();
         return adjustedCount;
     }
@@ -808,7 +991,7 @@ struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
     void refreshUIIfNeeded()
     {
         // Similarly we need to push values to a UI on startup
-        if (uiComms.refreshUIValues && clapJuceShim->isEditorAttached())
+        if (uiComms.refreshUIValues && isEditorAttached())
         {
             CNDOUT << "Refreshing UI" << std::endl;
             uiComms.refreshUIValues = false;
@@ -906,7 +1089,7 @@ struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
     void updateParamInPatch(const clap_event_param_value *v)
     {
         doValueUpdate(v->param_id, v->value);
-        if (clapJuceShim && clapJuceShim->isEditorAttached())
+        if (isEditorAttached())
         {
             auto r = ToUI();
             r.type = ToUI::PARAM_VALUE;
@@ -920,7 +1103,7 @@ struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
     void updateModulation(const clap_event_param_mod *v)
     {
         doMonoModulationUpdate(v->param_id, v->amount);
-        if (clapJuceShim && clapJuceShim->isEditorAttached())
+        if (isEditorAttached())
         {
             auto r = ToUI();
             r.type = ToUI::PARAM_MODULATION;
@@ -931,6 +1114,7 @@ struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
         }
     }
 
+#if !defined(CONDUIT_HEADLESS)
     bool registerOrUnregisterTimer(clap_id &id, int ms, bool reg) override
     {
         if (!_host.canUseTimerSupport())
@@ -945,6 +1129,48 @@ struct ClapBaseClass : public plugHelper_t, sst::clap_juce_shim::EditorProvider
         }
         return true;
     };
+#endif
+
+    /*
+     * Audio port activation. A plugin with optional outputs overrides
+     * implementsAudioPortsActivation to return true and checks isAudioOutputActive
+     * (or isAudioInputActive) once per block, skipping the work for ports the host
+     * has switched off. Ports start active and the host may flip them at any time,
+     * including while processing, so the flags are atomics the audio thread only reads.
+     */
+    static constexpr uint32_t maxActivatablePorts{16};
+    std::array<std::atomic<bool>, maxActivatablePorts> audioInputActive, audioOutputActive;
+
+    void resetAudioPortActivation()
+    {
+        for (auto &a : audioInputActive)
+            a.store(true, std::memory_order_relaxed);
+        for (auto &a : audioOutputActive)
+            a.store(true, std::memory_order_relaxed);
+    }
+
+    bool isAudioInputActive(uint32_t index) const
+    {
+        return index >= maxActivatablePorts ||
+               audioInputActive[index].load(std::memory_order_relaxed);
+    }
+    bool isAudioOutputActive(uint32_t index) const
+    {
+        return index >= maxActivatablePorts ||
+               audioOutputActive[index].load(std::memory_order_relaxed);
+    }
+
+    bool audioPortsActivationCanActivateWhileProcessing() const noexcept override { return true; }
+    bool audioPortsActivationSetActive(bool isInput, uint32_t portIndex, bool isActive,
+                                       uint32_t sampleSize) noexcept override
+    {
+        if (portIndex >= audioPortsCount(isInput) || portIndex >= maxActivatablePorts)
+            return false;
+
+        auto &flags = isInput ? audioInputActive : audioOutputActive;
+        flags[portIndex].store(isActive, std::memory_order_relaxed);
+        return true;
+    }
 
     virtual bool implementsPluginAsVST3() { return true; }
     virtual uint32_t getAsVst3NumMIDIChannels(int port) { return 16; }
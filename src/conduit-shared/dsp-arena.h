@@ -0,0 +1,259 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_CONDUIT_SHARED_DSP_ARENA_H
+#define CONDUIT_SRC_CONDUIT_SHARED_DSP_ARENA_H
+
+/*
+ * A per instance bump allocator for audio thread state. A plugin works out what it needs
+ * at activate, reserves it in one block and constructs its big objects (delay lines,
+ * effects) back to back inside it, so the hot data is contiguous and the instance's DSP
+ * footprint is just bytesUsed(). On linux a block of 2MB or more is aligned to and
+ * advised for transparent huge pages unless CONDUIT_NO_HUGE_PAGE_ARENAS is defined, which
+ * cuts TLB misses when walking long delay lines.
+ *
+ * reserve, reset and release are main thread only (activate / deactivate). Nothing is
+ * ever freed individually; reset destroys everything made, in reverse order.
+ *
+ * Once everything is made, prefault touches each page in use so the audio thread never
+ * takes a first touch fault, and lock (with CONDUIT_LOCK_DSP_MEMORY) keeps them resident.
+ * The static range versions do the same for state which lives outside the arena.
+ *
+ * At deactivate release hands the whole mapping back, and discardRange drops the resident
+ * pages of a buffer which lives outside it, like a voice's comb lines or a UI ring. The
+ * next activate reserves and prefaults again.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace sst::conduit::shared
+{
+struct DSPArena
+{
+    static constexpr size_t hugePageSize{2 * 1024 * 1024};
+
+    DSPArena() = default;
+    ~DSPArena() { release(); }
+    DSPArena(const DSPArena &) = delete;
+    DSPArena &operator=(const DSPArena &) = delete;
+
+    // How many bytes n T's will need, including worst case alignment padding
+    template <typename T> static constexpr size_t footprint(size_t n = 1)
+    {
+        return n * sizeof(T) + alignof(T);
+    }
+
+    bool reserve(size_t bytes)
+    {
+        reset();
+        if (bytes <= capacity)
+            return true;
+        release();
+
+#if defined(__unix__) || defined(__APPLE__)
+        auto wantHuge = bytes >= hugePageSize;
+        auto size = wantHuge ? roundUp(bytes, hugePageSize) + hugePageSize : bytes;
+        auto m = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (m == MAP_FAILED)
+            return false;
+        mapping = m;
+        mappingSize = size;
+        base = static_cast<unsigned char *>(m);
+        capacity = size;
+        if (wantHuge)
+        {
+            // THP needs 2MB aligned ranges, so start at the first boundary in the mapping
+            auto a = roundUp((uintptr_t)base, hugePageSize);
+            capacity = size - (a - (uintptr_t)base);
+            base = reinterpret_cast<unsigned char *>(a);
+#if defined(__linux__) && defined(MADV_HUGEPAGE) && !defined(CONDUIT_NO_HUGE_PAGE_ARENAS)
+            hugePages = madvise(base, roundDown(capacity, hugePageSize), MADV_HUGEPAGE) == 0;
+#endif
+        }
+#else
+        base = static_cast<unsigned char *>(
+            ::operator new(bytes, std::align_val_t(64), std::nothrow));
+        if (!base)
+            return false;
+        capacity = bytes;
+#endif
+        return true;
+    }
+
+    void *allocate(size_t size, size_t align)
+    {
+        auto p = roundUp((uintptr_t)base + used, align);
+        auto end = p + size - (uintptr_t)base;
+        if (!base || end > capacity)
+            return nullptr;
+        used = end;
+        return reinterpret_cast<void *>(p);
+    }
+
+    template <typename T, typename... Args> T *make(Args &&...args)
+    {
+        auto p = allocate(sizeof(T), alignof(T));
+        if (!p)
+            return nullptr;
+        auto t = new (p) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            destructors.push_back({t, [](void *q) { static_cast<T *>(q)->~T(); }});
+        return t;
+    }
+
+    void prefault() { prefaultRange(base, used); }
+
+    bool lock()
+    {
+        if (locked && lockedSize >= used)
+            return true;
+        if (!lockRange(base, used))
+            return false;
+        locked = true;
+        lockedSize = used;
+        return true;
+    }
+
+    /*
+     * An atomic add of zero to one byte per page faults it in writable without changing
+     * anything, even if another thread is busy with a neighbouring member in the range.
+     */
+    static void prefaultRange(void *p, size_t bytes)
+    {
+        if (!p || bytes == 0)
+            return;
+        auto page = pageSize();
+        auto c = static_cast<unsigned char *>(p);
+        for (size_t i = 0; i < bytes; i += page)
+            std::atomic_ref<unsigned char>(c[i]).fetch_add(0, std::memory_order_relaxed);
+        std::atomic_ref<unsigned char>(c[bytes - 1]).fetch_add(0, std::memory_order_relaxed);
+    }
+
+    static bool lockRange(void *p, size_t bytes)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        return p && bytes && mlock(p, bytes) == 0;
+#else
+        return false;
+#endif
+    }
+
+    static void unlockRange(void *p, size_t bytes)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        if (p && bytes)
+            munlock(p, bytes);
+#endif
+    }
+
+    /*
+     * Give the pages wholly inside the range back to the system while keeping the address
+     * range valid. Afterwards the contents read as zero (linux) or as whatever was there
+     * (macOS, until the kernel reclaims it), so only use it on buffers which are cleared
+     * before they are next read, and never on a locked range.
+     */
+    static void discardRange(void *p, size_t bytes)
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        if (!p || bytes == 0)
+            return;
+        auto s = roundUp((uintptr_t)p, pageSize());
+        auto e = roundDown((uintptr_t)p + bytes, pageSize());
+        if (e <= s)
+            return;
+#if defined(__APPLE__)
+        madvise(reinterpret_cast<void *>(s), e - s, MADV_FREE);
+#else
+        madvise(reinterpret_cast<void *>(s), e - s, MADV_DONTNEED);
+#endif
+#endif
+    }
+
+    void reset()
+    {
+        for (auto it = destructors.rbegin(); it != destructors.rend(); ++it)
+            it->second(it->first);
+        destructors.clear();
+        used = 0;
+    }
+
+    void release()
+    {
+        reset();
+        if (locked)
+            unlockRange(base, lockedSize);
+        locked = false;
+        lockedSize = 0;
+#if defined(__unix__) || defined(__APPLE__)
+        if (mapping)
+            munmap(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+#else
+        if (base)
+            ::operator delete(base, std::align_val_t(64));
+#endif
+        base = nullptr;
+        capacity = 0;
+        hugePages = false;
+    }
+
+    size_t bytesUsed() const { return used; }
+    size_t bytesReserved() const { return capacity; }
+    bool isHugePageBacked() const { return hugePages; }
+    bool isLocked() const { return locked; }
+
+  private:
+    static uintptr_t roundUp(uintptr_t v, size_t a) { return (v + a - 1) & ~(uintptr_t)(a - 1); }
+    static uintptr_t roundDown(uintptr_t v, size_t a) { return v & ~(uintptr_t)(a - 1); }
+    static size_t pageSize()
+    {
+#if defined(__unix__) || defined(__APPLE__)
+        static const size_t ps = (size_t)sysconf(_SC_PAGESIZE);
+        return ps;
+#else
+        return 4096;
+#endif
+    }
+
+    unsigned char *base{nullptr};
+    size_t capacity{0}, used{0};
+    bool hugePages{false};
+    bool locked{false};
+    size_t lockedSize{0};
+    void *mapping{nullptr};
+    size_t mappingSize{0};
+    std::vector<std::pair<void *, void (*)(void *)>> destructors;
+};
+} // namespace sst::conduit::shared
+
+#endif // CONDUIT_SRC_CONDUIT_SHARED_DSP_ARENA_H
@@ -33,6 +33,7 @@
 #include "sst/jucegui/components/MultiSwitch.h"
 #include "sst/jucegui/components/ToolTip.h"
 #include "debug-helpers.h"
+#include "trace-recorder.h"
 #include "version.h"
 #include "cmrc/cmrc.hpp"
 
@@ -45,6 +46,42 @@ namespace jcmp = sst::jucegui::components;
 static constexpr int headerSize{35};
 static constexpr int footerSize{18};
 
+/*
+ * Static chrome which doesn't change frame to frame gets painted once into an image
+ * at the device scale and blitted after that. Owners call invalidate when their size
+ * or style changes; a scale change (moving to another monitor) rebuilds automatically.
+ */
+struct CachedStaticLayer
+{
+    template <typename F> void paint(juce::Graphics &g, const juce::Component &c, F &&painter)
+    {
+        auto w = c.getWidth(), h = c.getHeight();
+        if (w <= 0 || h <= 0)
+            return;
+
+        auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        if (!cache.isValid() || scale != cacheScale || w != cacheW || h != cacheH)
+        {
+            cache = juce::Image(juce::Image::ARGB, (int)std::ceil(w * scale),
+                                (int)std::ceil(h * scale), true);
+            juce::Graphics ig(cache);
+            ig.addTransform(juce::AffineTransform::scale(scale));
+            painter(ig);
+            cacheScale = scale;
+            cacheW = w;
+            cacheH = h;
+        }
+        g.drawImage(cache, c.getLocalBounds().toFloat());
+    }
+
+    void invalidate() { cache = juce::Image(); }
+
+  private:
+    juce::Image cache;
+    float cacheScale{0.f};
+    int cacheW{0}, cacheH{0};
+};
+
 template <typename Content> struct EditorBase;
 
 template <typename Content> struct Background : sst::jucegui::components::WindowPanel
@@ -53,6 +90,17 @@ template <typename Content> struct Background : sst::jucegui::components::Window
     Background(const std::string &pluginName, const std::string &pluginId, EditorBase<Content> &e);
     void resized() override;
 
+    CachedStaticLayer staticLayer;
+    void paint(juce::Graphics &g) override
+    {
+        staticLayer.paint(g, *this, [this](auto &ig) { WindowPanel::paint(ig); });
+    }
+    void onStyleChanged() override
+    {
+        staticLayer.invalidate();
+        WindowPanel::onStyleChanged();
+    }
+
     void buildBurger();
     juce::Typeface::Ptr labelsTypeface{nullptr}, versionTypeface{nullptr};
 
@@ -62,6 +110,7 @@ template <typename Content> struct Background : sst::jucegui::components::Window
     std::unique_ptr<sst::jucegui::components::GlyphButton> menuButton;
 
     void loadsave(bool doSave);
+    void loadTuning(bool mapping);
     std::unique_ptr<juce::FileChooser> fileChooser;
 };
 
@@ -203,14 +252,22 @@ template <typename T, typename TEd> struct EditorCommunicationsHandler
 
     void onIdle()
     {
+        TraceScope tr("ui idle", uic.getTraceInstance());
+
+        // A plugin which has returned CLAP_PROCESS_SLEEP won't run until asked, so ask
+        if (uic.refreshUIValues)
+            uic.requestHostParamFlush();
         using ToUI = typename T::UICommunicationBundle::SynthToUI_Queue_t::value_type;
 
-        while (!uic.toUiQ.empty())
+        std::array<ToUI, 256> chunk;
+        while (auto n = uic.toUiQ.pop(chunk.data(), chunk.size()))
         {
-            auto r = *uic.toUiQ.pop();
-
-            if (r.type == ToUI::MType::PARAM_VALUE)
+            for (auto i = 0U; i < n; ++i)
             {
+                const auto &r = chunk[i];
+                if (r.type != ToUI::MType::PARAM_VALUE)
+                    continue;
+
                 auto p = dataTargets.find(r.id);
                 if (p != dataTargets.end())
                 {
@@ -227,9 +284,6 @@ template <typename T, typename TEd> struct EditorCommunicationsHandler
                     }
                 }
             }
-            else
-            {
-            }
         }
 
         for (auto &[k, f] : idleHandlers)
@@ -474,6 +528,8 @@ Background<Content>::Background(const std::string &pluginName, const std::string
 
 template <typename Content> void Background<Content>::resized()
 {
+    staticLayer.invalidate();
+
     auto lb = getLocalBounds();
     if (contents)
     {
@@ -497,6 +553,49 @@ template <typename Content> void Background<Content>::buildBurger()
     menu.addSectionHeader(eb.pluginName);
     eb.populatePluginHamburgerItems(menu);
     menu.addSeparator();
+
+    juce::PopupMenu frMenu;
+    auto frNow = eb.uic.getFlightRecorderTrigger();
+    for (auto f : {0.f, 0.5f, 0.75f, 0.9f, 1.f})
+    {
+        auto lab = f == 0.f ? std::string("Off")
+                            : "Dump above " + std::to_string((int)std::round(f * 100)) +
+                                  "% of deadline";
+        frMenu.addItem(lab, true, frNow == f, [w = juce::Component::SafePointer(this), f]() {
+            if (w)
+                w->eb.uic.setFlightRecorderTrigger(f);
+        });
+    }
+    if (auto *lt = eb.uic.getLocalTuning())
+    {
+        juce::PopupMenu tMenu;
+        tMenu.addSectionHeader("Current: " + lt->description);
+        tMenu.addItem("Load Scala Scale...", [w = juce::Component::SafePointer(this)]() {
+            if (w)
+                w->loadTuning(false);
+        });
+        tMenu.addItem("Load Keyboard Mapping...", [w = juce::Component::SafePointer(this)]() {
+            if (w)
+                w->loadTuning(true);
+        });
+        tMenu.addItem("Reset to Standard Tuning", [lt]() { lt->resetToStandard(); });
+        menu.addSubMenu("Tuning", tMenu);
+        menu.addSeparator();
+    }
+
+    menu.addSubMenu("Overload Flight Recorder", frMenu);
+    menu.addItem("Timeline Trace (All Instances)", true, eb.uic.isTracing(),
+                 [w = juce::Component::SafePointer(this)]() {
+                     if (w)
+                         w->eb.uic.setTracing(!w->eb.uic.isTracing());
+                 });
+    menu.addItem("Keep Memory While Deactivated", true, eb.uic.getKeepMemoryWhileInactive(),
+                 [w = juce::Component::SafePointer(this)]() {
+                     if (w)
+                         w->eb.uic.setKeepMemoryWhileInactive(
+                             !w->eb.uic.getKeepMemoryWhileInactive());
+                 });
+    menu.addSeparator();
     menu.addItem("Save Settings To...", [w = juce::Component::SafePointer(this)]() {
         if (w)
             w->loadsave(true);
@@ -565,7 +664,12 @@ template <typename Content> void Background<Content>::loadsave(bool doSave)
                 sv.type = FromUI::MType::SAVE_PATCH;
                 sv.strPointer = (char *)malloc(s.size() + 1);
                 strncpy(sv.strPointer, s.c_str(), s.size() + 1);
-                this->eb.uic.fromUiQ.push(sv);
+                // The patch IO handler frees the path; if the queue is full nobody will
+                if (!this->eb.uic.fromUiQ.push(sv))
+                {
+                    CNDOUT << "UI queue full; dropping patch request " << s << std::endl;
+                    free(sv.strPointer);
+                }
             }
         });
     }
@@ -587,11 +691,41 @@ template <typename Content> void Background<Content>::loadsave(bool doSave)
                 sv.type = FromUI::MType::LOAD_PATCH;
                 sv.strPointer = (char *)malloc(s.size() + 1);
                 strncpy(sv.strPointer, s.c_str(), s.size() + 1);
-                this->eb.uic.fromUiQ.push(sv);
+                // The patch IO handler frees the path; if the queue is full nobody will
+                if (!this->eb.uic.fromUiQ.push(sv))
+                {
+                    CNDOUT << "UI queue full; dropping patch request " << s << std::endl;
+                    free(sv.strPointer);
+                }
             }
         });
     }
 }
 
+template <typename Content> void Background<Content>::loadTuning(bool mapping)
+{
+    auto dp = eb.uic.getDocumentsPath();
+    fileChooser = std::make_unique<juce::FileChooser>(
+        mapping ? "Load Keyboard Mapping" : "Load Scala Scale", juce::File(dp.u8string()),
+        mapping ? "*.kbm" : "*.scl");
+
+    auto folderChooserFlags =
+        juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles;
+
+    fileChooser->launchAsync(folderChooserFlags, [this, mapping](auto &chooser) {
+        auto *lt = this->eb.uic.getLocalTuning();
+        if (!lt || !chooser.getResults().size())
+            return;
+
+        auto text = chooser.getResult().loadFileAsString().toStdString();
+        auto ok = mapping ? lt->loadMapping(text) : lt->loadScale(text);
+        if (!ok)
+        {
+            juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon,
+                                                   "Unable to load tuning", lt->lastError);
+        }
+    });
+}
+
 } // namespace sst::conduit::shared
 #endif // CONDUIT_EDITOR_BASE_H
@@ -0,0 +1,86 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_CONDUIT_SHARED_ENVELOPE_RATE_TABLE_H
+#define CONDUIT_SRC_CONDUIT_SHARED_ENVELOPE_RATE_TABLE_H
+
+#include <cmath>
+
+#include "table-cache.h"
+
+namespace sst::conduit::shared
+{
+/*
+ * The sst envelopes ask their provider for envelope_rate_linear_nowrap(f), which is
+ * blockSize * srInv * 2^-f, every time they update a stage. Rather than have every voice
+ * call pow every block, we tabulate srInv * 2^-f across the range the envelopes use and
+ * linearly interpolate, leaving the caller to multiply by its own block size.
+ *
+ * Tables are looked up once per sample rate on the main thread (from activate) through
+ * the TableCache, so every instance and voice in the process, and every process, shares
+ * one per rate. Arguments outside the tabulated range fall back to the direct calculation.
+ */
+struct EnvelopeRateTable
+{
+    // DiscreteStagesEnvelope uses a range of -8 to 5; leave room for shaped stages
+    static constexpr float minF{-10.f}, maxF{10.f};
+    static constexpr int stepsPerOctave{64};
+    static constexpr int nPoints{(int)((maxF - minF) * stepsPerOctave) + 1};
+
+    EnvelopeRateTable() = default;
+    explicit EnvelopeRateTable(double sr) { build(sr); }
+
+    void build(double sr)
+    {
+        sampleRate = sr;
+        srInv = 1.0 / sr;
+        for (int i = 0; i < nPoints; ++i)
+        {
+            auto f = minF + 1.0 * i / stepsPerOctave;
+            table[i] = (float)(srInv * std::pow(2.0, -f));
+        }
+        // one guard point so the interpolation can always read i + 1
+        table[nPoints] = table[nPoints - 1];
+    }
+
+    inline float rateLinear(float f) const
+    {
+        if (f < minF || f >= maxF)
+            return (float)(srInv * std::pow(2.f, -f));
+
+        auto fi = (f - minF) * stepsPerOctave;
+        auto i = (int)fi;
+        auto frac = fi - i;
+        return table[i] + frac * (table[i + 1] - table[i]);
+    }
+
+    static const EnvelopeRateTable *forSampleRate(double sr)
+    {
+        return &TableCache::get<EnvelopeRateTable>(
+            "envelope-rate", sr, [](auto &t, double rate) { t.build(rate); });
+    }
+
+    double sampleRate{0}, srInv{0};
+    float table[nPoints + 1]{};
+};
+} // namespace sst::conduit::shared
+
+#endif // CONDUIT_SRC_CONDUIT_SHARED_ENVELOPE_RATE_TABLE_H
@@ -0,0 +1,236 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#include "flight-recorder.h"
+
+#include <condition_variable>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "debug-helpers.h"
+#include "trace-recorder.h"
+
+namespace sst::conduit::shared
+{
+/*
+ * One background thread serves every recorder in the process. It polls, since the audio
+ * thread can only raise an atomic flag, and it only runs while some recorder is enabled.
+ */
+struct FlightRecorderDumpThread
+{
+    static FlightRecorderDumpThread &get()
+    {
+        static FlightRecorderDumpThread instance;
+        return instance;
+    }
+
+    void add(FlightRecorder *fr)
+    {
+        std::lock_guard<std::mutex> g(lock);
+        recorders.insert(fr);
+        if (!worker)
+        {
+            keepRunning = true;
+            worker = std::make_unique<std::thread>([this]() { run(); });
+        }
+    }
+
+    void remove(FlightRecorder *fr)
+    {
+        std::unique_ptr<std::thread> finished;
+        {
+            std::lock_guard<std::mutex> g(lock);
+            recorders.erase(fr);
+            if (recorders.empty() && worker)
+            {
+                keepRunning = false;
+                finished = std::move(worker);
+            }
+        }
+        if (finished)
+        {
+            cv.notify_all();
+            finished->join();
+        }
+    }
+
+    ~FlightRecorderDumpThread()
+    {
+        std::unique_ptr<std::thread> finished;
+        {
+            std::lock_guard<std::mutex> g(lock);
+            keepRunning = false;
+            finished = std::move(worker);
+        }
+        if (finished)
+        {
+            cv.notify_all();
+            finished->join();
+        }
+    }
+
+  private:
+    void run()
+    {
+        std::vector<FlightRecorder::Dump> dumps;
+        std::unique_lock<std::mutex> g(lock);
+        while (keepRunning)
+        {
+            cv.wait_for(g, std::chrono::milliseconds(100));
+            for (auto *fr : recorders)
+            {
+                if (fr->dumpRequested.load(std::memory_order_acquire))
+                {
+                    dumps.push_back(fr->takeDump());
+                    fr->dumpRequested.store(false, std::memory_order_release);
+                }
+            }
+
+            if (!dumps.empty())
+            {
+                g.unlock();
+                for (const auto &d : dumps)
+                    FlightRecorder::writeDump(d);
+                dumps.clear();
+                g.lock();
+            }
+        }
+    }
+
+    std::mutex lock;
+    std::condition_variable cv;
+    std::set<FlightRecorder *> recorders;
+    std::unique_ptr<std::thread> worker;
+    bool keepRunning{false};
+};
+
+FlightRecorder::~FlightRecorder()
+{
+    if (registered)
+        FlightRecorderDumpThread::get().remove(this);
+}
+
+void FlightRecorder::configure(const std::string &id, const std::filesystem::path &dir)
+{
+    pluginId = id;
+    dumpDirectory = dir / "Flight Recorder";
+}
+
+void FlightRecorder::setTriggerFraction(float f)
+{
+    triggerFraction.store(std::max(f, 0.f), std::memory_order_relaxed);
+    if (f > 0 && !registered)
+    {
+        FlightRecorderDumpThread::get().add(this);
+        registered = true;
+    }
+    else if (f <= 0 && registered)
+    {
+        FlightRecorderDumpThread::get().remove(this);
+        registered = false;
+    }
+}
+
+FlightRecorder::Dump FlightRecorder::takeDump()
+{
+    // Copy first so the file write doesn't race the ring, or hold the lock, any longer
+    auto trig = triggerBlock;
+    auto n = std::min<uint64_t>(trig + 1, ringSize);
+    Dump d{pluginId, dumpDirectory, sampleRate, getTriggerFraction(), trig, stateNames, {}};
+    auto &snap = d.records;
+    snap.resize(n);
+    for (uint64_t i = 0; i < n; ++i)
+        snap[i] = ring[(trig + 1 - n + i) & (ringSize - 1)];
+
+    // The audio thread starts a record by writing its block number, and it works forward
+    // from the slot after the trigger, which is the oldest record in the snapshot. So drop
+    // everything up to the last record which was reused before or while it was copied.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t firstIntact{0};
+    for (uint64_t i = 0; i < n; ++i)
+    {
+        auto expected = trig + 1 - n + i;
+        if (snap[i].block != expected || ring[expected & (ringSize - 1)].block != expected)
+            firstIntact = i + 1;
+    }
+    snap.erase(snap.begin(), snap.begin() + firstIntact);
+    return d;
+}
+
+void FlightRecorder::writeDump(const Dump &d)
+{
+    TraceScope tr("flight recorder dump", TraceRecorder::sharedInstance);
+
+    try
+    {
+        std::filesystem::create_directories(d.directory);
+    }
+    catch (const std::filesystem::filesystem_error &e)
+    {
+        CNDOUT << "Unable to create flight recorder directory " << e.what() << std::endl;
+        return;
+    }
+
+    auto t = std::time(nullptr);
+    char ts[64];
+    std::strftime(ts, sizeof(ts), "%Y%m%d-%H%M%S", std::localtime(&t));
+    auto fn = d.directory /
+              (d.pluginId + "-" + ts + "-block" + std::to_string(d.triggerBlock) + ".csv");
+
+    std::ofstream of(fn);
+    if (!of.is_open())
+    {
+        CNDOUT << "Unable to write flight recorder dump " << fn.string() << std::endl;
+        return;
+    }
+
+    of << "# plugin " << d.pluginId << "\n"
+       << "# sample_rate " << d.sampleRate << "\n"
+       << "# trigger_fraction " << d.triggerFraction << "\n"
+       << "# trigger_block " << d.triggerBlock << "\n";
+    of << "block,start_ns,duration_ns,frames,deadline_ns,load,voices,queue_drops,"
+          "note_on,note_off,note_expression,param_value,param_mod,midi,other";
+    for (const auto &sn : d.stateNames)
+        of << "," << (sn.empty() ? "-" : sn);
+    of << "\n";
+
+    for (const auto &r : d.records)
+    {
+        auto deadline = d.sampleRate > 0 ? 1e9 * r.frames / d.sampleRate : 0.0;
+        of << r.block << "," << r.startNs << "," << r.durationNs << "," << r.frames << ","
+           << std::fixed << std::setprecision(0) << deadline << "," << std::setprecision(3)
+           << (deadline > 0 ? r.durationNs / deadline : 0.0) << "," << r.voices << ","
+           << r.queueDrops;
+        for (auto e : r.events)
+            of << "," << e;
+        for (auto s : r.state)
+            of << "," << s;
+        of << "\n";
+    }
+    CNDOUT << "Wrote flight recorder dump " << fn.string() << std::endl;
+}
+} // namespace sst::conduit::shared
@@ -0,0 +1,244 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_CONDUIT_SHARED_FLIGHT_RECORDER_H
+#define CONDUIT_SRC_CONDUIT_SHARED_FLIGHT_RECORDER_H
+
+/*
+ * A flight recorder for process calls. Every block writes one fixed size record into
+ * a ring with plain stores: timing, frame count, incoming event counts by type, active
+ * voices and a few plugin specific state values. If a block takes more than a chosen
+ * fraction of its real time deadline, the audio thread just flags the recorder and a
+ * shared background thread copies the ring and writes it out as a csv next to the
+ * documents folder, so an intermittent overload leaves a record of the blocks before it.
+ *
+ * The records are read by the dump thread while the audio thread keeps writing. The dump
+ * only keeps records up to the one which triggered it, which the audio thread finished
+ * before raising the flag, but by the time the copy runs the writer has moved on and is
+ * overwriting the oldest records in that window. Those are dropped from the dump by
+ * checking each copied record still carries the block number it should.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <clap/events.h>
+#include <clap/process.h>
+
+namespace sst::conduit::shared
+{
+struct FlightRecord
+{
+    enum EventKind : uint32_t
+    {
+        NOTE_ON,
+        NOTE_OFF,
+        NOTE_EXPRESSION,
+        PARAM_VALUE,
+        PARAM_MOD,
+        MIDI,
+        OTHER,
+
+        nEventKinds
+    };
+    static constexpr size_t nStateSlots{4};
+
+    uint64_t block{0};
+    uint64_t startNs{0};
+    uint32_t durationNs{0};
+    uint32_t frames{0};
+    uint32_t voices{0};
+    uint32_t queueDrops{0}; // running total over the watched queues
+    std::array<uint16_t, nEventKinds> events{};
+    std::array<float, nStateSlots> state{};
+};
+
+struct FlightRecorder
+{
+    static constexpr size_t ringSize{4096};
+    static_assert((ringSize & (ringSize - 1)) == 0);
+
+    FlightRecorder() = default;
+    ~FlightRecorder();
+    FlightRecorder(const FlightRecorder &) = delete;
+    FlightRecorder &operator=(const FlightRecorder &) = delete;
+
+    /*
+     * Main thread configuration. A fraction of 0 turns the recorder off, and 0.8 dumps
+     * when a block takes more than 80% of frames / sampleRate. The plugin names its
+     * state slots so the dump columns are readable.
+     */
+    void configure(const std::string &pluginId, const std::filesystem::path &dumpDirectory);
+    void setTriggerFraction(float f);
+    float getTriggerFraction() const { return triggerFraction.load(std::memory_order_relaxed); }
+    std::array<std::string, FlightRecord::nStateSlots> stateNames;
+
+    // Record the running overflow count of a queue (see SPSCQueue) with each block
+    template <typename Q> void watchQueue(const Q &q)
+    {
+        if (nWatchedQueues == watchedQueues.size())
+            return;
+        watchedQueues[nWatchedQueues++] = {
+            &q, [](const void *p) { return static_cast<const Q *>(p)->overflowCount(); }};
+    }
+
+    // Audio thread
+    double sampleRate{0};
+
+    void beginBlock(const clap_process *process)
+    {
+        active = triggerFraction.load(std::memory_order_relaxed) > 0.f;
+        if (!active)
+            return;
+
+        auto &r = ring[block & (ringSize - 1)];
+        r.block = block;
+        r.startNs = nowNs();
+        r.frames = process->frames_count;
+        r.voices = 0;
+        r.events = {};
+
+        auto ev = process->in_events;
+        auto sz = ev->size(ev);
+        for (auto i = 0U; i < sz; ++i)
+        {
+            auto k = kindOf(ev->get(ev, i));
+            if (r.events[k] < UINT16_MAX)
+                r.events[k]++;
+        }
+    }
+
+    void setVoices(uint32_t v) { ring[block & (ringSize - 1)].voices = v; }
+    void setState(size_t slot, float v) { ring[block & (ringSize - 1)].state[slot] = v; }
+
+    void endBlock()
+    {
+        if (!active)
+            return;
+
+        auto &r = ring[block & (ringSize - 1)];
+        auto endNs = nowNs();
+        r.durationNs = (uint32_t)std::min<uint64_t>(endNs - r.startNs, UINT32_MAX);
+
+        uint64_t drops{0};
+        for (auto i = 0U; i < nWatchedQueues; ++i)
+            drops += watchedQueues[i].overflowCount(watchedQueues[i].queue);
+        r.queueDrops = (uint32_t)std::min<uint64_t>(drops, UINT32_MAX);
+
+        auto deadlineNs = sampleRate > 0 ? 1e9 * r.frames / sampleRate : 0.0;
+        auto f = triggerFraction.load(std::memory_order_relaxed);
+
+        // Don't let a run of overloads write a run of nearly identical dumps
+        if (r.durationNs > f * deadlineNs && block >= nextTriggerAllowed &&
+            !dumpRequested.load(std::memory_order_relaxed))
+        {
+            nextTriggerAllowed = block + ringSize / 2;
+            triggerBlock = block;
+            dumpRequested.store(true, std::memory_order_release);
+        }
+        block++;
+    }
+
+    struct ScopedBlock
+    {
+        FlightRecorder &fr;
+        ScopedBlock(FlightRecorder &f, const clap_process *p) : fr(f) { fr.beginBlock(p); }
+        ~ScopedBlock() { fr.endBlock(); }
+    };
+    ScopedBlock scopedBlock(const clap_process *p) { return ScopedBlock(*this, p); }
+
+  private:
+    friend struct FlightRecorderDumpThread;
+
+    static uint64_t nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+    static uint32_t kindOf(const clap_event_header_t *e)
+    {
+        if (e->space_id != CLAP_CORE_EVENT_SPACE_ID)
+            return FlightRecord::OTHER;
+        switch (e->type)
+        {
+        case CLAP_EVENT_NOTE_ON:
+            return FlightRecord::NOTE_ON;
+        case CLAP_EVENT_NOTE_OFF:
+        case CLAP_EVENT_NOTE_CHOKE:
+            return FlightRecord::NOTE_OFF;
+        case CLAP_EVENT_NOTE_EXPRESSION:
+            return FlightRecord::NOTE_EXPRESSION;
+        case CLAP_EVENT_PARAM_VALUE:
+            return FlightRecord::PARAM_VALUE;
+        case CLAP_EVENT_PARAM_MOD:
+            return FlightRecord::PARAM_MOD;
+        case CLAP_EVENT_MIDI:
+        case CLAP_EVENT_MIDI_SYSEX:
+        case CLAP_EVENT_MIDI2:
+            return FlightRecord::MIDI;
+        }
+        return FlightRecord::OTHER;
+    }
+
+    std::array<FlightRecord, ringSize> ring{};
+
+    struct WatchedQueue
+    {
+        const void *queue{nullptr};
+        uint64_t (*overflowCount)(const void *){nullptr};
+    };
+    std::array<WatchedQueue, 4> watchedQueues{};
+    size_t nWatchedQueues{0};
+    uint64_t block{0}, nextTriggerAllowed{0}, triggerBlock{0};
+    bool active{false};
+    std::atomic<float> triggerFraction{0.f};
+    std::atomic<bool> dumpRequested{false};
+
+    // Only touched on the main thread or by the dump thread under its lock
+    std::string pluginId;
+    std::filesystem::path dumpDirectory;
+    bool registered{false};
+
+    // A dump is copied out under the lock and written after it is released, so a slow
+    // disk holds up neither other recorders nor an instance being destroyed
+    struct Dump
+    {
+        std::string pluginId;
+        std::filesystem::path directory;
+        double sampleRate{0};
+        float triggerFraction{0};
+        uint64_t triggerBlock{0};
+        std::array<std::string, FlightRecord::nStateSlots> stateNames;
+        std::vector<FlightRecord> records;
+    };
+    Dump takeDump();
+    static void writeDump(const Dump &d);
+};
+} // namespace sst::conduit::shared
+
+#endif // CONDUIT_SRC_CONDUIT_SHARED_FLIGHT_RECORDER_H
@@ -0,0 +1,112 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_CONDUIT_SHARED_INT16_SINC_DELAY_LINE_H
+#define CONDUIT_SRC_CONDUIT_SHARED_INT16_SINC_DELAY_LINE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "sse-include.h"
+#include "sst/basic-blocks/tables/SincTableProvider.h"
+
+namespace sst::conduit::shared
+{
+/*
+ * A drop-in for sst::basic_blocks::dsp::SSESincDelayLine which stores its samples as
+ * 16 bit integers rather than floats. Long delay lines are limited by memory bandwidth,
+ * not arithmetic, so halving the bytes per tap read is worth a couple of integer unpacks.
+ *
+ * Samples are written with headroom (so feedback sums above 1.0 don't clip right away)
+ * and first order error feedback noise shaping, which pushes the quantization noise up
+ * towards nyquist. The read is the same 12 point sinc as the float line, with the
+ * int16 -> float decode done four lanes at a time.
+ */
+template <size_t COMB_SIZE> struct Int16SincDelayLine
+{
+    static_assert((COMB_SIZE & (COMB_SIZE - 1)) == 0, "COMB_SIZE must be a power of two");
+
+    using sincTable_t = sst::basic_blocks::tables::SurgeSincTableProvider;
+    static constexpr int FIRipol_N{sincTable_t::FIRipol_N};
+    static constexpr int FIRipol_M{sincTable_t::FIRipol_M};
+    static_assert(FIRipol_N == 12, "The vectorized decode below assumes a 12 point sinc");
+
+    static constexpr float headroom{4.f};
+    static constexpr float encodeScale{32767.f / headroom};
+    static constexpr float decodeScale{headroom / 32767.f};
+
+    int16_t buffer alignas(16)[COMB_SIZE + FIRipol_N];
+    int wp{0};
+    float shapingError{0.f};
+    const sincTable_t &st;
+
+    Int16SincDelayLine(const sincTable_t &s) : st(s) { clear(); }
+
+    inline void write(float f)
+    {
+        auto v = f * encodeScale - shapingError;
+        auto q = std::clamp(std::nearbyint(v), -32767.f, 32767.f);
+        // If we clipped, don't let the shaper wind itself up chasing the error
+        shapingError = std::clamp(q - v, -1.f, 1.f);
+
+        auto s = (int16_t)q;
+        buffer[wp] = s;
+        buffer[wp + (wp < FIRipol_N) * COMB_SIZE] = s;
+        wp = (wp + 1) & (COMB_SIZE - 1);
+    }
+
+    inline float read(float delay) const
+    {
+        auto iDelay = (int)delay;
+        auto fracDelay = delay - iDelay;
+        auto sincTableOffset = (int)((1 - fracDelay) * FIRipol_M) * FIRipol_N * 2;
+        int readPtr = (wp - iDelay - (FIRipol_N >> 1)) & (COMB_SIZE - 1);
+
+        // Twelve taps are one 8 wide and one 4 wide load. Sign extend to int32 by
+        // unpacking each lane against itself and arithmetic shifting back down.
+        auto lo8 = _mm_loadu_si128((const __m128i *)&buffer[readPtr]);
+        auto hi4 = _mm_loadl_epi64((const __m128i *)&buffer[readPtr + 8]);
+        auto a = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(lo8, lo8), 16));
+        auto b = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(lo8, lo8), 16));
+        auto c = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(hi4, hi4), 16));
+
+        a = _mm_mul_ps(a, _mm_load_ps(&st.sinctable[sincTableOffset]));
+        b = _mm_mul_ps(b, _mm_load_ps(&st.sinctable[sincTableOffset + 4]));
+        c = _mm_mul_ps(c, _mm_load_ps(&st.sinctable[sincTableOffset + 8]));
+        a = _mm_add_ps(_mm_add_ps(a, b), c);
+
+        auto s = _mm_add_ps(a, _mm_movehl_ps(a, a));
+        s = _mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_cvtss_f32(s) * decodeScale;
+    }
+
+    void clear()
+    {
+        memset(buffer, 0, sizeof(buffer));
+        wp = 0;
+        shapingError = 0.f;
+    }
+};
+} // namespace sst::conduit::shared
+
+#endif // CONDUIT_SRC_CONDUIT_SHARED_INT16_SINC_DELAY_LINE_H
@@ -0,0 +1,384 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#include "local-tuning.h"
+
+#include <memory>
+#include <sstream>
+#include <thread>
+
+#include "debug-helpers.h"
+
+namespace sst::conduit::shared
+{
+LocalTuning::LocalTuning()
+{
+    for (auto &s : storage)
+        s.setStandard();
+}
+
+namespace
+{
+int floorDiv(int a, int b) { return (a >= 0 ? a : a - b + 1) / b; }
+
+// An MTS frequency word: semitone, then a 14 bit fraction of a semitone above it
+bool mtsFrequency(const uint8_t *p, double &freq)
+{
+    if (p[0] == 0x7F && p[1] == 0x7F && p[2] == 0x7F)
+        return false; // "no change"
+    auto semis = (p[0] & 0x7F) + (((p[1] & 0x7F) << 7) + (p[2] & 0x7F)) / 16384.0;
+    freq = TuningSnapshot::standardFrequency(semis);
+    return true;
+}
+} // namespace
+
+bool LocalTuning::applySysex(const uint8_t *data, uint32_t size)
+{
+    if (size > 0 && data[0] == 0xF0)
+    {
+        data++;
+        size--;
+    }
+    if (size > 0 && data[size - 1] == 0xF7)
+        size--;
+
+    // universal (non) real time, device, MIDI tuning standard, sub id
+    if (size < 4 || (data[0] != 0x7E && data[0] != 0x7F) || data[2] != 0x08)
+        return false;
+
+    auto sub = data[3];
+    auto p = data + 4;
+    auto end = data + size;
+    double f;
+
+    auto begin = [this]() { *scratch = *active; };
+    auto publish = [this]() { std::swap(active, scratch); };
+
+    switch (sub)
+    {
+    case 0x01:
+    {
+        // program, 16 byte name, 128 frequency words, checksum
+        if (end - p < 1 + 16 + 128 * 3)
+            return false;
+        p += 17;
+        begin();
+        for (int k = 0; k < TuningSnapshot::nKeys; ++k, p += 3)
+            if (mtsFrequency(p, f))
+                scratch->setKey(k, f);
+        publish();
+        return true;
+    }
+    case 0x02:
+    case 0x07:
+    {
+        // [bank] program count (key frequency)*count
+        p += (sub == 0x07) ? 2 : 1;
+        if (end - p < 1)
+            return false;
+        auto n = *p++;
+        begin();
+        for (int i = 0; i < n && end - p >= 4; ++i, p += 4)
+            if (mtsFrequency(p + 1, f))
+                scratch->setKey(p[0] & 0x7F, f);
+        publish();
+        return true;
+    }
+    case 0x08:
+    case 0x09:
+    {
+        // three channel mask bytes then a cents offset per pitch class, in one or two bytes
+        auto bytes = (sub == 0x08) ? 1 : 2;
+        if (end - p < 3 + 12 * bytes)
+            return false;
+        uint32_t mask = ((p[0] & 0x03) << 14) | ((p[1] & 0x7F) << 7) | (p[2] & 0x7F);
+        p += 3;
+
+        double cents[12];
+        for (int i = 0; i < 12; ++i)
+        {
+            if (bytes == 1)
+                cents[i] = (p[i] & 0x7F) - 64;
+            else
+                cents[i] =
+                    ((((p[2 * i] & 0x7F) << 7) + (p[2 * i + 1] & 0x7F)) - 8192) * 100.0 / 8192;
+        }
+
+        begin();
+        for (int c = 0; c < TuningSnapshot::nChannels; ++c)
+        {
+            if (!(mask & (1 << c)))
+                continue;
+            for (int k = 0; k < TuningSnapshot::nKeys; ++k)
+                scratch->setKey(c, k,
+                                TuningSnapshot::standardFrequency(k + cents[k % 12] * 0.01));
+        }
+        publish();
+        return true;
+    }
+    }
+    return false;
+}
+
+void LocalTuning::publishFromMainThread(const TuningSnapshot &s)
+{
+    // The audio thread only holds TAKING for a pointer swap, so spinning here is brief
+    while (true)
+    {
+        uint32_t expected = IDLE;
+        if (handoff.compare_exchange_strong(expected, WRITING, std::memory_order_acq_rel))
+            break;
+        expected = READY;
+        if (handoff.compare_exchange_strong(expected, WRITING, std::memory_order_acq_rel))
+            break;
+        std::this_thread::yield();
+    }
+    *staged = s;
+    handoff.store(READY, std::memory_order_release);
+}
+
+bool LocalTuning::setScaleAndMapping(const std::string &scl, const std::string &kbm)
+{
+    Scale s;
+    KeyboardMapping m;
+    std::string err;
+    if (!parseScale(scl, s, err) || !parseMapping(kbm, m, err))
+    {
+        CNDOUT << "Unable to load tuning: " << err << std::endl;
+        lastError = err;
+        return false;
+    }
+
+    auto snap = std::make_unique<TuningSnapshot>();
+    if (scl.empty() && kbm.empty())
+        snap->setStandard();
+    else
+        buildTables(s, m, *snap);
+    publishFromMainThread(*snap);
+
+    sclText = scl;
+    kbmText = kbm;
+    description = scl.empty() ? "12-TET" : s.description;
+    if (!kbm.empty())
+        description += " (mapped)";
+    lastError.clear();
+    return true;
+}
+
+namespace
+{
+// The next line which isn't a ! comment, trimmed. False at the end of the text
+bool nextLine(std::istringstream &is, std::string &line)
+{
+    while (std::getline(is, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (!line.empty() && line[0] == '!')
+            continue;
+        auto b = line.find_first_not_of(" \t");
+        line = (b == std::string::npos) ? "" : line.substr(b);
+        return true;
+    }
+    return false;
+}
+} // namespace
+
+bool LocalTuning::parseScale(const std::string &text, Scale &s, std::string &error)
+{
+    if (text.empty())
+    {
+        s.description = "12-TET";
+        s.cents.clear();
+        for (int i = 1; i <= 12; ++i)
+            s.cents.push_back(i * 100.0);
+        return true;
+    }
+
+    std::istringstream is(text);
+    std::string line;
+    if (!nextLine(is, s.description) || !nextLine(is, line))
+    {
+        error = "scale is missing its description or note count";
+        return false;
+    }
+
+    int count{0};
+    try
+    {
+        count = std::stoi(line);
+    }
+    catch (const std::exception &)
+    {
+        error = "scale note count '" + line + "' is not a number";
+        return false;
+    }
+    if (count < 1 || count > 1024)
+    {
+        error = "scale note count " + std::to_string(count) + " is out of range";
+        return false;
+    }
+
+    s.cents.clear();
+    while ((int)s.cents.size() < count && nextLine(is, line))
+    {
+        if (line.empty())
+            continue;
+        auto tok = line.substr(0, line.find_first_of(" \t"));
+        try
+        {
+            if (tok.find('.') != std::string::npos)
+            {
+                s.cents.push_back(std::stod(tok));
+            }
+            else
+            {
+                auto sl = tok.find('/');
+                auto num = std::stod(tok.substr(0, sl));
+                auto den = sl == std::string::npos ? 1.0 : std::stod(tok.substr(sl + 1));
+                if (num <= 0 || den <= 0)
+                    throw std::invalid_argument("ratio");
+                s.cents.push_back(1200.0 * std::log2(num / den));
+            }
+        }
+        catch (const std::exception &)
+        {
+            error = "scale degree '" + tok + "' is neither cents nor a ratio";
+            return false;
+        }
+    }
+    if ((int)s.cents.size() != count)
+    {
+        error = "scale has " + std::to_string(s.cents.size()) + " of " + std::to_string(count) +
+                " degrees";
+        return false;
+    }
+    return true;
+}
+
+bool LocalTuning::parseMapping(const std::string &text, KeyboardMapping &m, std::string &error)
+{
+    m = KeyboardMapping();
+    if (text.empty())
+        return true;
+
+    std::istringstream is(text);
+    std::string line;
+    std::array<double, 7> header{};
+    for (auto &h : header)
+    {
+        if (!nextLine(is, line))
+        {
+            error = "keyboard mapping header is incomplete";
+            return false;
+        }
+        try
+        {
+            h = std::stod(line);
+        }
+        catch (const std::exception &)
+        {
+            error = "keyboard mapping value '" + line + "' is not a number";
+            return false;
+        }
+    }
+    m.mapSize = (int)header[0];
+    m.firstNote = std::clamp((int)header[1], 0, 127);
+    m.lastNote = std::clamp((int)header[2], 0, 127);
+    m.middleNote = (int)header[3];
+    m.referenceNote = std::clamp((int)header[4], 0, 127);
+    m.referenceFrequency = header[5];
+    m.octaveDegree = (int)header[6];
+    if (m.mapSize < 0 || m.mapSize > 128 || m.referenceFrequency <= 0)
+    {
+        error = "keyboard mapping size or reference frequency is out of range";
+        return false;
+    }
+
+    while ((int)m.keys.size() < m.mapSize && nextLine(is, line))
+    {
+        if (line.empty())
+            continue;
+        if (line[0] == 'x' || line[0] == 'X')
+        {
+            m.keys.push_back(-1);
+            continue;
+        }
+        try
+        {
+            m.keys.push_back(std::stoi(line));
+        }
+        catch (const std::exception &)
+        {
+            error = "keyboard mapping entry '" + line + "' is not a degree or x";
+            return false;
+        }
+    }
+    // Scala allows the trailing map entries to be left off; they are unmapped
+    m.keys.resize(m.mapSize, -1);
+    return true;
+}
+
+/*
+ * Keys map to scale degrees relative to the middle note, repeating every mapSize keys by
+ * the octave degree, or one key per degree with no map. The degree gives cents from the
+ * period structure of the scale and the reference note pins the absolute frequency.
+ * Unmapped keys and keys outside first to last note stay at 12-TET.
+ */
+void LocalTuning::buildTables(const Scale &s, const KeyboardMapping &m, TuningSnapshot &into)
+{
+    auto n = (int)s.cents.size();
+    auto octaveDegree = m.octaveDegree > 0 ? m.octaveDegree : n;
+
+    auto centsFor = [&](int key, bool &mapped) {
+        mapped = true;
+        auto rel = key - m.middleNote;
+        auto degree = rel;
+        if (m.mapSize > 0)
+        {
+            auto octs = floorDiv(rel, m.mapSize);
+            auto entry = m.keys[rel - octs * m.mapSize];
+            if (entry < 0)
+            {
+                mapped = false;
+                return 0.0;
+            }
+            degree = octs * octaveDegree + entry;
+        }
+        auto periods = floorDiv(degree, n);
+        auto idx = degree - periods * n;
+        return periods * s.cents[n - 1] + (idx == 0 ? 0.0 : s.cents[idx - 1]);
+    };
+
+    bool refMapped;
+    auto refCents = centsFor(m.referenceNote, refMapped);
+
+    into.setStandard();
+    for (int k = m.firstNote; k <= m.lastNote; ++k)
+    {
+        bool mapped;
+        auto c = centsFor(k, mapped);
+        if (mapped)
+            into.setKey(k, m.referenceFrequency * std::pow(2.0, (c - refCents) / 1200.0));
+    }
+    into.isStandard = false;
+}
+} // namespace sst::conduit::shared
@@ -0,0 +1,158 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_CONDUIT_SHARED_LOCAL_TUNING_H
+#define CONDUIT_SRC_CONDUIT_SHARED_LOCAL_TUNING_H
+
+/*
+ * Tuning which lives in the plugin rather than in an MTS-ESP master. A scale can come from
+ * .scl and .kbm text, loaded on the main thread, or from MIDI Tuning Standard sysex which
+ * arrives with the audio. Either way the result is a TuningSnapshot: a frequency and a
+ * retuning-from-12-TET table for every key on every channel, so a voice does a lookup.
+ *
+ * The audio thread reads one snapshot which is never written while it is current. A sysex
+ * copies it into a scratch snapshot, edits that and swaps the two. The main thread builds
+ * its tables into a third, staged snapshot and the audio thread swaps that in at the top
+ * of a block; a small state machine keeps the two threads off the staged one at the same
+ * time. None of this allocates or locks on the audio thread.
+ *
+ * Sysex changes are not streamed, since an MTS sender resends its tuning when it starts;
+ * the scale and mapping text are, by the base class, when a plugin sets streamedTuning.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace sst::conduit::shared
+{
+struct TuningSnapshot
+{
+    static constexpr int nChannels{16};
+    static constexpr int nKeys{128};
+
+    bool isStandard{true};
+    std::array<std::array<double, nKeys>, nChannels> frequency{};
+    std::array<std::array<float, nKeys>, nChannels> retuningSemitones{};
+
+    static double standardFrequency(double key) { return 440.0 * std::pow(2.0, (key - 69) / 12.0); }
+
+    void setStandard()
+    {
+        for (int k = 0; k < nKeys; ++k)
+            setKey(k, standardFrequency(k));
+        isStandard = true;
+    }
+    void setKey(int key, double freq)
+    {
+        for (int c = 0; c < nChannels; ++c)
+            setKey(c, key, freq);
+    }
+    void setKey(int channel, int key, double freq)
+    {
+        frequency[channel][key] = freq;
+        retuningSemitones[channel][key] = (float)(12.0 * std::log2(freq / standardFrequency(key)));
+        isStandard = false;
+    }
+
+    double frequencyFor(int key, int channel) const
+    {
+        return frequency[channel & (nChannels - 1)][std::clamp(key, 0, nKeys - 1)];
+    }
+    float retuningFor(int key, int channel) const
+    {
+        return retuningSemitones[channel & (nChannels - 1)][std::clamp(key, 0, nKeys - 1)];
+    }
+};
+
+struct LocalTuning
+{
+    LocalTuning();
+    LocalTuning(const LocalTuning &) = delete;
+    LocalTuning &operator=(const LocalTuning &) = delete;
+
+    // Audio thread
+    const TuningSnapshot &current() const { return *active; }
+    bool isRetuned() const { return !active->isStandard; }
+
+    // Call at the top of a block. True if a new main thread tuning is now current
+    bool pickUpFromMainThread()
+    {
+        uint32_t expected = READY;
+        if (!handoff.compare_exchange_strong(expected, TAKING, std::memory_order_acq_rel))
+            return false;
+        std::swap(active, staged);
+        handoff.store(IDLE, std::memory_order_release);
+        return true;
+    }
+
+    /*
+     * Apply an MTS bulk dump (08 01), single note change (08 02 and 08 07) or scale/octave
+     * message (08 08 and 08 09). The leading F0 and trailing F7 are optional. Returns true
+     * if the message was a tuning message, whether or not it changed anything.
+     */
+    bool applySysex(const uint8_t *data, uint32_t size);
+
+    // Main thread. Empty text means 12-TET, or the standard mapping. False on a parse error
+    bool setScaleAndMapping(const std::string &scl, const std::string &kbm);
+    bool loadScale(const std::string &scl) { return setScaleAndMapping(scl, kbmText); }
+    bool loadMapping(const std::string &kbm) { return setScaleAndMapping(sclText, kbm); }
+    void resetToStandard() { setScaleAndMapping("", ""); }
+
+    std::string sclText, kbmText, description{"12-TET"}, lastError;
+
+    struct Scale
+    {
+        std::string description;
+        std::vector<double> cents; // the degrees after the unison; the last is the period
+    };
+    struct KeyboardMapping
+    {
+        int mapSize{0}, firstNote{0}, lastNote{127}, middleNote{60}, referenceNote{60};
+        double referenceFrequency{261.6255653005986};
+        int octaveDegree{0};
+        std::vector<int> keys; // -1 for an unmapped key
+    };
+    static bool parseScale(const std::string &text, Scale &s, std::string &error);
+    static bool parseMapping(const std::string &text, KeyboardMapping &m, std::string &error);
+    static void buildTables(const Scale &s, const KeyboardMapping &m, TuningSnapshot &into);
+
+  private:
+    enum HandoffState : uint32_t
+    {
+        IDLE,
+        WRITING,
+        READY,
+        TAKING
+    };
+    std::atomic<uint32_t> handoff{IDLE};
+    void publishFromMainThread(const TuningSnapshot &s);
+
+    std::array<TuningSnapshot, 3> storage;
+    TuningSnapshot *active{&storage[0]}, *scratch{&storage[1]}, *staged{&storage[2]};
+};
+} // namespace sst::conduit::shared
+
+#endif // CONDUIT_SRC_CONDUIT_SHARED_LOCAL_TUNING_H
@@ -0,0 +1,185 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_CONDUIT_SHARED_POLYPHASE_UPSAMPLER_H
+#define CONDUIT_SRC_CONDUIT_SHARED_POLYPHASE_UPSAMPLER_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "sse-include.h"
+#include "table-cache.h"
+
+namespace sst::conduit::shared
+{
+/*
+ * A stereo integer-factor polyphase interpolator, used to run an engine at a fraction
+ * of a high host sample rate and bring it back up at the plugin boundary.
+ *
+ * The prototype is a Kaiser windowed sinc of tapsPerPhase * factor points with its cutoff
+ * a little under the engine nyquist. It is split into factor phases of tapsPerPhase taps,
+ * stored time reversed so each output sample is a straight SSE dot product against the
+ * history, which we keep twice over so the window is always contiguous. The design for each
+ * factor comes from the TableCache and is copied in on configure.
+ *
+ * Usage is pull style: when needsInput() push one engine rate sample, then pop() one
+ * host rate sample; every push makes factor samples available.
+ */
+struct PolyphaseUpsampler
+{
+    static constexpr int maxFactor{8};
+    static constexpr int tapsPerPhase{32};
+    static_assert(tapsPerPhase % 4 == 0, "Phases are read four taps at a time");
+
+    static constexpr double kaiserBeta{8.0};
+    static constexpr double passbandFraction{0.9};
+
+    /*
+     * The smallest integer factor which brings hostRate to at most maxEngineRate, so a
+     * 192k session runs at 96k, 176.4k at 88.2k, and anything at or under the limit at 1.
+     */
+    static int factorFor(double hostRate, double maxEngineRate)
+    {
+        auto f = (int)std::ceil(hostRate / maxEngineRate - 1e-6);
+        return std::clamp(f, 1, maxFactor);
+    }
+
+    struct Coefficients
+    {
+        float c alignas(16)[maxFactor][tapsPerPhase];
+    };
+
+    void configure(int f)
+    {
+        factor = std::clamp(f, 1, maxFactor);
+        const auto &table =
+            TableCache::get<Coefficients>("polyphase-upsampler", factor, design);
+        memcpy(coefs, table.c, sizeof(coefs));
+        reset();
+    }
+
+    static void design(Coefficients &d, int factor)
+    {
+        auto n = factor * tapsPerPhase;
+        auto center = 0.5 * (n - 1);
+        auto cutoff = passbandFraction * 0.5 / factor; // in cycles per output sample
+        auto i0Beta = besselI0(kaiserBeta);
+
+        memset(d.c, 0, sizeof(d.c));
+        for (int i = 0; i < n; ++i)
+        {
+            auto t = i - center;
+            auto x = 2.0 * M_PI * cutoff * t;
+            auto sinc = (std::fabs(x) < 1e-9) ? 1.0 : std::sin(x) / x;
+            auto r = t / center;
+            auto w = besselI0(kaiserBeta * std::sqrt(std::max(0.0, 1.0 - r * r))) / i0Beta;
+
+            // gain of factor makes up for the zeros we are notionally stuffing
+            auto h = factor * 2.0 * cutoff * sinc * w;
+
+            auto phase = i % factor;
+            auto tap = i / factor;
+            d.c[phase][tapsPerPhase - 1 - tap] = (float)h;
+        }
+    }
+
+    void reset()
+    {
+        memset(history, 0, sizeof(history));
+        memset(pending, 0, sizeof(pending));
+        histPos = 0;
+        pendingPos = maxFactor;
+    }
+
+    // Group delay in host rate samples, for anyone who wants to report latency
+    int latency() const { return factor == 1 ? 0 : (factor * tapsPerPhase - 1) / 2; }
+
+    bool needsInput() const { return pendingPos >= factor; }
+
+    void push(float L, float R)
+    {
+        history[0][histPos] = L;
+        history[0][histPos + tapsPerPhase] = L;
+        history[1][histPos] = R;
+        history[1][histPos + tapsPerPhase] = R;
+        histPos = (histPos + 1) & (tapsPerPhase - 1);
+
+        // oldest to newest, with the newest at the end to meet the reversed coefficients
+        const float *hL = &history[0][histPos];
+        const float *hR = &history[1][histPos];
+        for (int p = 0; p < factor; ++p)
+        {
+            auto accL = _mm_setzero_ps();
+            auto accR = _mm_setzero_ps();
+            for (int k = 0; k < tapsPerPhase; k += 4)
+            {
+                auto c = _mm_load_ps(&coefs[p][k]);
+                accL = _mm_add_ps(accL, _mm_mul_ps(c, _mm_loadu_ps(hL + k)));
+                accR = _mm_add_ps(accR, _mm_mul_ps(c, _mm_loadu_ps(hR + k)));
+            }
+            pending[0][p] = horizontalSum(accL);
+            pending[1][p] = horizontalSum(accR);
+        }
+        pendingPos = 0;
+    }
+
+    void pop(float &L, float &R)
+    {
+        L = pending[0][pendingPos];
+        R = pending[1][pendingPos];
+        pendingPos++;
+    }
+
+    int factor{1};
+
+  private:
+    static_assert((tapsPerPhase & (tapsPerPhase - 1)) == 0, "History wraps with a mask");
+
+    static float horizontalSum(__m128 a)
+    {
+        auto t = _mm_add_ps(a, _mm_movehl_ps(a, a));
+        t = _mm_add_ss(t, _mm_shuffle_ps(t, t, _MM_SHUFFLE(1, 1, 1, 1)));
+        return _mm_cvtss_f32(t);
+    }
+
+    static double besselI0(double x)
+    {
+        double sum{1.0}, term{1.0};
+        for (int k = 1; k < 32; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum += term;
+            if (term < 1e-12 * sum)
+                break;
+        }
+        return sum;
+    }
+
+    float coefs alignas(16)[maxFactor][tapsPerPhase];
+    float history alignas(16)[2][2 * tapsPerPhase];
+    float pending[2][maxFactor];
+    int histPos{0};
+    int pendingPos{maxFactor};
+};
+} // namespace sst::conduit::shared
+
+#endif // CONDUIT_SRC_CONDUIT_SHARED_POLYPHASE_UPSAMPLER_H
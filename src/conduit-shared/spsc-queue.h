@@ -0,0 +1,140 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_CONDUIT_SHARED_SPSC_QUEUE_H
+#define CONDUIT_SRC_CONDUIT_SHARED_SPSC_QUEUE_H
+
+/*
+ * A wait-free single producer / single consumer queue for the audio <-> UI traffic.
+ *
+ * Head and tail live on separate cache lines, each next to a private copy of the other
+ * side's index, so in the steady state neither side touches the other's line. Both
+ * sides move whole spans: push(items, n) and pop(out, max) do at most two memcpys and
+ * one atomic store, which is what you want when draining a few thousand messages in an
+ * idle callback. Items must therefore be trivially copyable.
+ *
+ * A full queue drops rather than blocks, and the drops are counted in overflowCount.
+ * "Single" means one thread at a time on each side; the host-serialized audio thread and
+ * paramsFlush calls both count as the one consumer of the UI queue, for instance.
+ */
+
+#include <array>
+#include <atomic>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace sst::conduit::shared
+{
+template <typename T, size_t N> struct SPSCQueue
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SPSCQueue items are moved with memcpy");
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SPSCQueue size must be a power of two");
+
+    using value_type = T;
+    static constexpr size_t capacity{N};
+    static constexpr size_t cacheLine{64};
+
+    // Producer side
+    bool push(const T &item) { return push(&item, 1) == 1; }
+    size_t push(const T *items, size_t n)
+    {
+        auto t = tail.load(std::memory_order_relaxed);
+        if (N - (t - headCache) < n)
+            headCache = head.load(std::memory_order_acquire);
+
+        auto count = std::min(n, N - (size_t)(t - headCache));
+        writeSpan(items, t, count);
+        tail.store(t + count, std::memory_order_release);
+
+        if (count < n)
+            overflows.fetch_add(n - count, std::memory_order_relaxed);
+        return count;
+    }
+
+    // Consumer side
+    bool pop(T &item) { return pop(&item, 1) == 1; }
+    size_t pop(T *out, size_t max)
+    {
+        auto h = head.load(std::memory_order_relaxed);
+        if (tailCache - h < max)
+            tailCache = tail.load(std::memory_order_acquire);
+
+        auto count = std::min(max, (size_t)(tailCache - h));
+        readSpan(out, h, count);
+        head.store(h + count, std::memory_order_release);
+        return count;
+    }
+    bool empty() const
+    {
+        return head.load(std::memory_order_relaxed) == tail.load(std::memory_order_acquire);
+    }
+
+    // Either side, approximate
+    size_t size() const
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+    uint64_t overflowCount() const { return overflows.load(std::memory_order_relaxed); }
+
+    /*
+     * Consumer side, with the producer stopped: drop anything unread so the storage can be
+     * discarded (see DSPArena::discardRange) without a later pop seeing the cleared pages.
+     */
+    void clear()
+    {
+        tailCache = tail.load(std::memory_order_acquire);
+        head.store(tailCache, std::memory_order_release);
+    }
+    void *storage() { return data.data(); }
+    static constexpr size_t storageBytes{sizeof(T) * N};
+
+  private:
+    // Each span is at most two segments, either side of the wrap point
+    void writeSpan(const T *from, uint64_t pos, size_t count)
+    {
+        auto idx = (size_t)(pos & (N - 1));
+        auto first = std::min(count, N - idx);
+        std::memcpy(&data[idx], from, first * sizeof(T));
+        std::memcpy(&data[0], from + first, (count - first) * sizeof(T));
+    }
+    void readSpan(T *to, uint64_t pos, size_t count) const
+    {
+        auto idx = (size_t)(pos & (N - 1));
+        auto first = std::min(count, N - idx);
+        std::memcpy(to, &data[idx], first * sizeof(T));
+        std::memcpy(to + first, &data[0], (count - first) * sizeof(T));
+    }
+
+    // Indices count up forever and are masked on use; 64 bits will not wrap
+    alignas(cacheLine) std::atomic<uint64_t> head{0};
+    uint64_t tailCache{0};
+
+    alignas(cacheLine) std::atomic<uint64_t> tail{0};
+    uint64_t headCache{0};
+    std::atomic<uint64_t> overflows{0};
+
+    alignas(cacheLine) std::array<T, N> data;
+};
+} // namespace sst::conduit::shared
+
+#endif // CONDUIT_SRC_CONDUIT_SHARED_SPSC_QUEUE_H
@@ -0,0 +1,298 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#include "table-cache.h"
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "sst/plugininfra/paths.h"
+
+#include "debug-helpers.h"
+#include "version.h"
+
+namespace sst::conduit::shared
+{
+namespace
+{
+struct TableFileHeader
+{
+    char magic[8];
+    uint32_t formatVersion;
+    uint32_t headerSize;
+    uint64_t tableSize;
+    uint64_t key;
+    uint64_t checksum;
+};
+static_assert(sizeof(TableFileHeader) <= TableCache::headerSize);
+constexpr char tableMagic[8]{'C', 'N', 'D', 'T', 'A', 'B', 'L', 0};
+
+// FNV-1a; this is a consistency check against stale and torn files, not a security one
+uint64_t fnv1a(const void *data, size_t n, uint64_t h = 0xcbf29ce484222325ULL)
+{
+    auto c = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < n; ++i)
+    {
+        h ^= c[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+uint64_t keyFor(const std::string &name, const void *params, size_t paramsSize, size_t size,
+                size_t align)
+{
+    std::ostringstream oss;
+    oss << name << "/" << size << "/" << align << "/" << TableCache::formatVersion << "/"
+        << build::FullVersionStr << "/" << build::GitHash << "/" << build::BuildArch;
+    auto s = oss.str();
+    auto h = fnv1a(s.data(), s.size());
+    return params ? fnv1a(params, paramsSize, h) : h;
+}
+
+std::filesystem::path cacheDirectory()
+{
+    try
+    {
+        auto d = sst::plugininfra::paths::bestDocumentsFolderPathFor("Conduit") / "TableCache";
+        std::filesystem::create_directories(d);
+        return d;
+    }
+    catch (const std::filesystem::filesystem_error &e)
+    {
+        CNDOUT << "No table cache directory: " << e.what() << std::endl;
+    }
+    return {};
+}
+
+bool headerMatches(const TableFileHeader &h, size_t size, uint64_t key)
+{
+    return memcmp(h.magic, tableMagic, sizeof(tableMagic)) == 0 &&
+           h.formatVersion == TableCache::formatVersion &&
+           h.headerSize == TableCache::headerSize && h.tableSize == size && h.key == key;
+}
+
+/*
+ * Returns the table inside a valid file, or nullptr. On unix that is a read only shared
+ * mapping; elsewhere the file is read into memory, which still saves the computation.
+ */
+const void *load(const std::filesystem::path &fn, size_t size, uint64_t key)
+{
+    auto total = TableCache::headerSize + size;
+#if defined(__unix__) || defined(__APPLE__)
+    auto fd = open(fn.c_str(), O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size != total)
+    {
+        close(fd);
+        return nullptr;
+    }
+    auto m = mmap(nullptr, total, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED)
+        return nullptr;
+
+    auto base = static_cast<const unsigned char *>(m);
+    TableFileHeader h;
+    memcpy(&h, base, sizeof(h));
+    auto table = base + TableCache::headerSize;
+    if (!headerMatches(h, size, key) || fnv1a(table, size) != h.checksum)
+    {
+        munmap(m, total);
+        return nullptr;
+    }
+    return table;
+#else
+    std::ifstream in(fn, std::ios::binary);
+    if (!in.is_open())
+        return nullptr;
+    TableFileHeader h;
+    in.read(reinterpret_cast<char *>(&h), sizeof(h));
+    if (!in || !headerMatches(h, size, key))
+        return nullptr;
+    in.seekg(TableCache::headerSize);
+    auto table = ::operator new(size, std::align_val_t(TableCache::headerSize));
+    in.read(static_cast<char *>(table), size);
+    if (!in || fnv1a(table, size) != h.checksum)
+    {
+        ::operator delete(table, std::align_val_t(TableCache::headerSize));
+        return nullptr;
+    }
+    return table;
+#endif
+}
+
+bool store(const std::filesystem::path &fn, const void *table, size_t size, uint64_t key)
+{
+    TableFileHeader h{};
+    memcpy(h.magic, tableMagic, sizeof(tableMagic));
+    h.formatVersion = TableCache::formatVersion;
+    h.headerSize = TableCache::headerSize;
+    h.tableSize = size;
+    h.key = key;
+    h.checksum = fnv1a(table, size);
+
+    unsigned char header[TableCache::headerSize]{};
+    memcpy(header, &h, sizeof(h));
+
+    // Unique enough per thread and moment that two writers never share a temporary
+    std::ostringstream suffix;
+    suffix << ".tmp-" << std::this_thread::get_id() << "-"
+           << std::chrono::steady_clock::now().time_since_epoch().count();
+    auto tmp = fn;
+    tmp += suffix.str();
+    {
+        std::ofstream of(tmp, std::ios::binary | std::ios::trunc);
+        if (!of.is_open())
+            return false;
+        of.write(reinterpret_cast<const char *>(header), sizeof(header));
+        of.write(static_cast<const char *>(table), size);
+        if (!of)
+        {
+            of.close();
+            std::error_code ec;
+            std::filesystem::remove(tmp, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmp, fn, ec);
+    if (ec)
+    {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+/*
+ * Remove cache files nobody has loaded for maxUnusedDays, along with temporaries a crashed
+ * writer left behind. Loads refresh the time on their file, so anything any installed
+ * build still uses stays. Mappings held by running instances stay valid after the unlink.
+ */
+void removeUnused(const std::filesystem::path &dir)
+{
+    auto now = std::filesystem::file_time_type::clock::now();
+    auto unusedAfter = std::chrono::hours(24 * TableCache::maxUnusedDays);
+    auto abandonedAfter = std::chrono::hours(24);
+
+    std::error_code ec;
+    for (const auto &e : std::filesystem::directory_iterator(dir, ec))
+    {
+        auto p = e.path();
+        auto isTemp = p.filename().string().find(".bin.tmp-") != std::string::npos;
+        if (p.extension() != ".bin" && !isTemp)
+            continue;
+
+        std::error_code tec;
+        auto t = std::filesystem::last_write_time(p, tec);
+        if (tec || now - t < (isTemp ? abandonedAfter : unusedAfter))
+            continue;
+
+        std::error_code rec;
+        if (std::filesystem::remove(p, rec))
+            CNDOUT << "Removed unused table cache file " << p.string() << std::endl;
+    }
+}
+
+void markUsed(const std::filesystem::path &fn)
+{
+    std::error_code ec;
+    std::filesystem::last_write_time(fn, std::filesystem::file_time_type::clock::now(), ec);
+}
+
+const void *acquireFile(const std::string &name, uint64_t key, size_t size,
+                        const std::function<void(void *)> &build)
+{
+    auto dir = cacheDirectory();
+
+    std::filesystem::path fn;
+    if (!dir.empty())
+    {
+        static std::once_flag sweep;
+        std::call_once(sweep, [&dir]() { removeUnused(dir); });
+
+        std::ostringstream oss;
+        oss << name << "-" << std::hex << key << ".bin";
+        fn = dir / oss.str();
+        if (auto t = load(fn, size, key))
+        {
+            markUsed(fn);
+            return t;
+        }
+    }
+
+    auto table = ::operator new(size, std::align_val_t(TableCache::headerSize));
+    build(table);
+
+    if (!fn.empty() && store(fn, table, size, key))
+    {
+        if (auto t = load(fn, size, key))
+        {
+            ::operator delete(table, std::align_val_t(TableCache::headerSize));
+            return t;
+        }
+    }
+    CNDOUT << "Table '" << name << "' is not cached; using a private copy" << std::endl;
+    return table;
+}
+} // namespace
+
+const void *TableCache::acquire(const std::string &name, const void *params, size_t paramsSize,
+                                size_t size, size_t align,
+                                const std::function<void(void *)> &build)
+{
+    // Tables with params are shared by id within the process, like the per type statics
+    static std::mutex keyedMutex;
+    static std::unordered_map<uint64_t, const void *> keyedTables;
+
+    auto key = keyFor(name, params, paramsSize, size, align);
+    std::unique_lock<std::mutex> lock(keyedMutex, std::defer_lock);
+    if (params)
+    {
+        lock.lock();
+        auto p = keyedTables.find(key);
+        if (p != keyedTables.end())
+            return p->second;
+    }
+
+    auto t = acquireFile(name, key, size, build);
+    if (params)
+        keyedTables[key] = t;
+    return t;
+}
+} // namespace sst::conduit::shared
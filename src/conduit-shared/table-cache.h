@@ -0,0 +1,113 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_CONDUIT_SHARED_TABLE_CACHE_H
+#define CONDUIT_SRC_CONDUIT_SHARED_TABLE_CACHE_H
+
+/*
+ * Precomputed lookup tables, built once per machine rather than once per instance.
+ *
+ * The first ask for a table in a process looks for its file in the TableCache folder under
+ * the Conduit documents path. The name carries a key made of the table name, its type's
+ * size and alignment and the conduit build, and the header repeats the key along with a
+ * checksum of the table. If it all matches, the file is mapped read only and every instance
+ * in the process, and every process on the machine, shares those pages. If not, the table
+ * is built in memory as usual, written to a temporary file and renamed into place (so a
+ * racing process never maps half a file) and then mapped. Anything going wrong with the
+ * file just leaves us with the built copy, logged.
+ *
+ * Tables are never released. There is one per type, or one per type and parameters for the
+ * tables (like per sample rate ones) which take some. The table's bytes are the file format,
+ * so tables and their parameters must be trivially copyable and callers only get a const
+ * reference.
+ *
+ * Builds key their files differently, and several builds can be installed side by side, so
+ * nothing is removed because another build made it. Instead each load refreshes its file's
+ * modification time and, once per process, files nobody has used for maxUnusedDays go.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <string>
+#include <type_traits>
+
+namespace sst::conduit::shared
+{
+struct TableCache
+{
+    static constexpr uint32_t formatVersion{1};
+    // The table starts this far into the file, and this is the most alignment it can want
+    static constexpr size_t headerSize{64};
+    static constexpr int maxUnusedDays{60};
+
+    /*
+     * Build is handed a default constructed Table to finish off, so for the sst providers
+     * which fill in at construction it can be left out.
+     */
+    template <typename Table>
+    static const Table &get(const char *name, void (*build)(Table &) = nullptr)
+    {
+        static_assert(std::is_trivially_copyable_v<Table>, "Cached tables are stored as bytes");
+        static_assert(alignof(Table) <= headerSize, "Cached tables are aligned to the header");
+
+        static const Table *table{nullptr};
+        static std::once_flag once;
+        std::call_once(once, [&]() {
+            table = static_cast<const Table *>(
+                acquire(name, nullptr, 0, sizeof(Table), alignof(Table), [build](void *p) {
+                    auto t = new (p) Table();
+                    if (build)
+                        build(*t);
+                }));
+        });
+        return *table;
+    }
+
+    /*
+     * The same for a table which depends on params, built by build(table, params). Each
+     * distinct params gets its own table and file. This takes a lock, so look the table up
+     * once (on activate, say) and hold on to the reference.
+     */
+    template <typename Table, typename Params, typename Build>
+    static const Table &get(const char *name, const Params &params, Build &&build)
+    {
+        static_assert(std::is_trivially_copyable_v<Table>, "Cached tables are stored as bytes");
+        static_assert(std::is_trivially_copyable_v<Params>, "Table params are keyed as bytes");
+        static_assert(alignof(Table) <= headerSize, "Cached tables are aligned to the header");
+
+        return *static_cast<const Table *>(acquire(
+            name, &params, sizeof(Params), sizeof(Table), alignof(Table), [&](void *p) {
+                auto t = new (p) Table();
+                build(*t, params);
+            }));
+    }
+
+  private:
+    static const void *acquire(const std::string &name, const void *params, size_t paramsSize,
+                               size_t size, size_t align,
+                               const std::function<void(void *)> &build);
+};
+} // namespace sst::conduit::shared
+
+#endif // CONDUIT_SRC_CONDUIT_SHARED_TABLE_CACHE_H
@@ -0,0 +1,233 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#include "trace-recorder.h"
+
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+
+#include "debug-helpers.h"
+
+namespace sst::conduit::shared
+{
+TraceRecorder &TraceRecorder::get()
+{
+    static TraceRecorder instance;
+    return instance;
+}
+
+TraceRecorder::~TraceRecorder() { stop(); }
+
+uint32_t TraceRecorder::registerInstance(const std::string &label)
+{
+    std::lock_guard<std::mutex> g(lock);
+    auto id = nextInstance++;
+    instanceLabels[id] = {label};
+    return id;
+}
+
+void TraceRecorder::unregisterInstance(uint32_t instance)
+{
+    if (instance == sharedInstance)
+        return;
+
+    std::lock_guard<std::mutex> g(lock);
+    auto p = instanceLabels.find(instance);
+    if (p == instanceLabels.end())
+        return;
+    if (writer)
+        p->second.retired = true;
+    else
+        instanceLabels.erase(p);
+}
+
+bool TraceRecorder::start(const std::filesystem::path &directory)
+{
+    std::lock_guard<std::mutex> g(lock);
+    if (writer)
+        return true;
+
+    if (ringStorage.empty())
+    {
+        for (auto i = 0U; i < maxThreads; ++i)
+        {
+            ringStorage.push_back(std::make_unique<ThreadRing>());
+            rings[i] = ringStorage.back().get();
+        }
+    }
+
+    // Anything left over from a scope which closed as the last trace stopped goes
+    for (auto *r : rings)
+        r->read.store(r->write.load(std::memory_order_acquire), std::memory_order_release);
+
+    try
+    {
+        std::filesystem::create_directories(directory);
+    }
+    catch (const std::filesystem::filesystem_error &e)
+    {
+        CNDOUT << "Unable to create trace directory " << e.what() << std::endl;
+        return false;
+    }
+
+    auto t = std::time(nullptr);
+    char ts[64];
+    std::strftime(ts, sizeof(ts), "%Y%m%d-%H%M%S", std::localtime(&t));
+    auto fn = directory / (std::string("conduit-trace-") + ts + ".json");
+
+    std::ofstream of(fn);
+    if (!of.is_open())
+    {
+        CNDOUT << "Unable to write timeline trace " << fn.string() << std::endl;
+        return false;
+    }
+
+    keepWriting = true;
+    auto originNs = nowNs();
+    writer = std::make_unique<std::thread>([this, of = std::move(of), fn, originNs]() mutable {
+        writeLoop(std::move(of), fn, originNs);
+    });
+    tracing.store(true, std::memory_order_release);
+    CNDOUT << "Timeline trace started to " << fn.string() << std::endl;
+    return true;
+}
+
+void TraceRecorder::stop()
+{
+    std::unique_ptr<std::thread> finished;
+    {
+        std::lock_guard<std::mutex> g(lock);
+        if (!writer)
+            return;
+        tracing.store(false, std::memory_order_release);
+        keepWriting = false;
+        finished = std::move(writer);
+    }
+    finished->join();
+
+    std::lock_guard<std::mutex> g(lock);
+    std::erase_if(instanceLabels, [](const auto &p) { return p.second.retired; });
+}
+
+namespace
+{
+std::string jsonEscaped(const std::string &s)
+{
+    std::string res;
+    for (auto c : s)
+    {
+        if (c == '"' || c == '\\')
+            res += '\\';
+        if ((unsigned char)c >= 0x20)
+            res += c;
+    }
+    return res;
+}
+} // namespace
+
+/*
+ * Polls the rings rather than being woken, since the recording side can't signal. Each
+ * scope is a complete ("X") event with the ring slot as its thread id, and each instance
+ * is its own process row, so instances sharing a host thread line up on the same tid.
+ */
+void TraceRecorder::writeLoop(std::ofstream of, std::filesystem::path fn, uint64_t originNs)
+{
+    of << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    of << std::fixed << std::setprecision(3);
+
+    bool first{true};
+    auto sep = [&]() -> std::ofstream & {
+        if (!first)
+            of << ",\n";
+        first = false;
+        return of;
+    };
+
+    uint32_t labelsWritten{0};
+    std::vector<std::pair<uint32_t, std::string>> labels;
+    uint64_t droppedReported{unclaimedDropped.load(std::memory_order_relaxed)};
+    for (auto *r : rings)
+        droppedReported += r->dropped.load(std::memory_order_relaxed);
+
+    auto drain = [&]() {
+        labels.clear();
+        {
+            std::lock_guard<std::mutex> g(lock);
+            for (auto p = instanceLabels.lower_bound(labelsWritten); p != instanceLabels.end();
+                 ++p)
+                labels.emplace_back(p->first, p->second.label);
+            labelsWritten = nextInstance;
+            std::erase_if(instanceLabels, [&](const auto &p) {
+                return p.second.retired && p.first < labelsWritten;
+            });
+        }
+        for (const auto &[id, label] : labels)
+        {
+            sep() << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << id
+                  << ",\"args\":{\"name\":\"" << jsonEscaped(label) << "\"}}";
+        }
+
+        uint64_t dropped{unclaimedDropped.load(std::memory_order_relaxed)};
+        for (auto slot = 0U; slot < maxThreads; ++slot)
+        {
+            auto *r = rings[slot];
+            dropped += r->dropped.load(std::memory_order_relaxed);
+
+            auto rd = r->read.load(std::memory_order_relaxed);
+            auto wr = r->write.load(std::memory_order_acquire);
+            for (; rd < wr; ++rd)
+            {
+                const auto &e = r->events[rd & (eventsPerThread - 1)];
+                if (e.startNs < originNs)
+                    continue;
+                sep() << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":" << e.instance
+                      << ",\"tid\":" << slot << ",\"ts\":" << (e.startNs - originNs) * 0.001
+                      << ",\"dur\":" << e.durationNs * 0.001 << "}";
+            }
+            r->read.store(rd, std::memory_order_release);
+        }
+        if (dropped != droppedReported)
+        {
+            CNDOUT << "Timeline trace dropped " << dropped - droppedReported
+                   << " events; the writer is not keeping up or too many threads are tracing"
+                   << std::endl;
+            droppedReported = dropped;
+        }
+    };
+
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> g(lock);
+            if (!keepWriting)
+                break;
+        }
+        drain();
+        of.flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    drain();
+
+    of << "\n]}\n";
+    CNDOUT << "Wrote timeline trace " << fn.string() << std::endl;
+}
+} // namespace sst::conduit::shared
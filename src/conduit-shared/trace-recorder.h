@@ -0,0 +1,208 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_CONDUIT_SHARED_TRACE_RECORDER_H
+#define CONDUIT_SRC_CONDUIT_SHARED_TRACE_RECORDER_H
+
+/*
+ * An opt-in timeline tracer shared by every conduit instance in the process. Code marks
+ * a region with a TraceScope and, while tracing is on, the scope's start and duration go
+ * into a ring owned by the calling thread. A background thread drains the rings into a
+ * Chrome trace-event json file which chrome://tracing or ui.perfetto.dev will open, so
+ * you can see how several instances share the host audio threads next to the ui and
+ * worker threads.
+ *
+ * Nothing is allocated or locked on the recording side. The rings are made the first
+ * time tracing starts and a thread claims one with a compare and swap on first use, so
+ * after that a scope is two clock reads and a few plain stores. A thread gives its ring
+ * back as it exits, so hosts which come and go through worker threads don't run out; a
+ * later thread on the same ring shares its row in the trace. Events which find no ring,
+ * or a full one, are counted as dropped. When tracing is off a scope is a single relaxed
+ * load. Tracing starts from the editor menu, or at the first instance when the
+ * CONDUIT_TRACE environment variable is set.
+ */
+
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sst::conduit::shared
+{
+struct TraceEvent
+{
+    const char *name{nullptr}; // must be a string literal or otherwise outlive the trace
+    uint64_t startNs{0};
+    uint32_t durationNs{0};
+    uint32_t instance{0};
+};
+
+struct TraceRecorder
+{
+    static constexpr size_t maxThreads{32};
+    static constexpr size_t eventsPerThread{8192};
+    static_assert((eventsPerThread & (eventsPerThread - 1)) == 0);
+
+    // Instance 0 is for work which belongs to no plugin, like the shared dump threads
+    static constexpr uint32_t sharedInstance{0};
+
+    static TraceRecorder &get();
+
+    static bool isTracing() { return tracing.load(std::memory_order_acquire); }
+    static uint64_t nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // Main thread. Labels name the instance in the trace until it unregisters
+    uint32_t registerInstance(const std::string &label);
+    void unregisterInstance(uint32_t instance);
+    // False, with tracing still off, if the trace file can't be made
+    bool start(const std::filesystem::path &directory);
+    void stop();
+
+    // Any thread
+    void record(const char *name, uint32_t instance, uint64_t startNs, uint64_t endNs)
+    {
+        auto *r = ringForThisThread();
+        if (!r)
+        {
+            unclaimedDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        auto w = r->write.load(std::memory_order_relaxed);
+        if (w - r->read.load(std::memory_order_acquire) >= eventsPerThread)
+        {
+            r->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        auto &e = r->events[w & (eventsPerThread - 1)];
+        e.name = name;
+        e.startNs = startNs;
+        e.durationNs = (uint32_t)std::min<uint64_t>(endNs - startNs, UINT32_MAX);
+        e.instance = instance;
+        r->write.store(w + 1, std::memory_order_release);
+    }
+
+    ~TraceRecorder();
+
+  private:
+    TraceRecorder() = default;
+
+    struct ThreadRing
+    {
+        std::atomic<uint64_t> write{0}, read{0}, dropped{0};
+        std::array<TraceEvent, eventsPerThread> events{};
+    };
+
+    // Held by a thread_local, so the slot is released when its thread exits
+    struct SlotClaim
+    {
+        int32_t slot{-1};
+        ~SlotClaim()
+        {
+            if (slot >= 0)
+                TraceRecorder::get().slotInUse[slot].store(false, std::memory_order_release);
+        }
+    };
+
+    ThreadRing *ringForThisThread()
+    {
+        thread_local SlotClaim claim;
+        if (claim.slot < 0)
+        {
+            for (auto i = 0U; i < maxThreads; ++i)
+            {
+                auto expected{false};
+                if (!slotInUse[i].load(std::memory_order_relaxed) &&
+                    slotInUse[i].compare_exchange_strong(expected, true,
+                                                         std::memory_order_acquire))
+                {
+                    claim.slot = (int32_t)i;
+                    break;
+                }
+            }
+            if (claim.slot < 0)
+                return nullptr;
+        }
+        return rings[claim.slot];
+    }
+
+    static inline std::atomic<bool> tracing{false};
+
+    // Made at the first start, before tracing is released, and kept until exit
+    std::array<ThreadRing *, maxThreads> rings{};
+    std::vector<std::unique_ptr<ThreadRing>> ringStorage;
+    std::array<std::atomic<bool>, maxThreads> slotInUse{};
+    std::atomic<uint64_t> unclaimedDropped{0};
+
+    /*
+     * Instance labels and the writer state are guarded by lock. Ids are never reused, and
+     * an instance which unregisters while tracing keeps its label until the writer has
+     * named its row.
+     */
+    struct InstanceLabel
+    {
+        std::string label;
+        bool retired{false};
+    };
+    std::mutex lock;
+    std::map<uint32_t, InstanceLabel> instanceLabels{{sharedInstance, {"conduit"}}};
+    uint32_t nextInstance{sharedInstance + 1};
+    std::unique_ptr<std::thread> writer;
+    bool keepWriting{false};
+    void writeLoop(std::ofstream of, std::filesystem::path file, uint64_t originNs);
+};
+
+struct TraceScope
+{
+    const char *name;
+    uint32_t instance;
+    uint64_t startNs{0};
+
+    TraceScope(const char *n, uint32_t i) : name(n), instance(i)
+    {
+        if (TraceRecorder::isTracing())
+            startNs = TraceRecorder::nowNs();
+    }
+    ~TraceScope()
+    {
+        // A scope which began before tracing started is skipped rather than stretched
+        if (startNs && TraceRecorder::isTracing())
+            TraceRecorder::get().record(name, instance, startNs, TraceRecorder::nowNs());
+    }
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+};
+} // namespace sst::conduit::shared
+
+#endif // CONDUIT_SRC_CONDUIT_SHARED_TRACE_RECORDER_H
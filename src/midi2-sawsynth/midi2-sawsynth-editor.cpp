@@ -118,15 +118,12 @@ struct ConduitMIDI2SawSynthEditor : public sst::jucegui::accessibility::IgnoredC
     void pullEvents()
     {
         bool dorp{false};
-        while (!uic.dataCopyForUI.eventBuf.empty())
+        // These are a page each, so pop straight into place rather than in chunks
+        while (uic.dataCopyForUI.eventBuf.pop(scratchEvt))
         {
-            auto ib = uic.dataCopyForUI.eventBuf.pop();
-            if (ib.has_value())
+            if (includeEvent(scratchEvt))
             {
-                if (includeEvent(*ib))
-                {
-                    events.push_front(*ib);
-                }
+                events.push_front(scratchEvt);
             }
             dorp = true;
         }
@@ -340,6 +337,7 @@ struct ConduitMIDI2SawSynthEditor : public sst::jucegui::accessibility::IgnoredC
     }
     std::unique_ptr<jcmp::NamedPanel> evtPanel, ctrlPanel;
     std::deque<ConduitMIDI2SawSynthConfig::DataCopyForUI::evtCopy> events;
+    ConduitMIDI2SawSynthConfig::DataCopyForUI::evtCopy scratchEvt;
     EventPainter *eventPainterWeak{nullptr};
     juce::Typeface::Ptr fixedFace{nullptr};
     bool noteOnly{true};
@@ -20,7 +20,9 @@
  */
 
 #include "midi2-sawsynth.h"
+#if !defined(CONDUIT_HEADLESS)
 #include "juce_gui_basics/juce_gui_basics.h"
+#endif
 #include "version.h"
 
 #include <midi/midi2_channel_voice_message.h>
@@ -81,8 +83,7 @@ ConduitMIDI2SawSynth::ConduitMIDI2SawSynth(const clap_host *host)
 
     configureParams();
 
-    clapJuceShim = std::make_unique<sst::clap_juce_shim::ClapJuceShim>(this);
-    clapJuceShim->setResizable(true);
+    setupEditorShim(true);
 }
 
 ConduitMIDI2SawSynth::~ConduitMIDI2SawSynth() {}
@@ -116,6 +117,9 @@ bool ConduitMIDI2SawSynth::notePortsInfo(uint32_t index, bool isInput,
 
 clap_process_status ConduitMIDI2SawSynth::process(const clap_process *process) noexcept
 {
+    auto frBlock = flightRecorder.scopedBlock(process);
+    auto trBlock = traceScope("process");
+
     auto ev = process->in_events;
     auto sz = ev->size(ev);
 
@@ -30,7 +30,7 @@
 
 #include <memory>
 #include "sst/basic-blocks/params/ParamMetadata.h"
-#include "sst/cpputils/ring_buffer.h"
+#include "conduit-shared/spsc-queue.h"
 
 #include "conduit-shared/clap-base-class.h"
 #include "sst/voicemanager/voicemanager.h"
@@ -67,7 +67,7 @@ struct ConduitMIDI2SawSynthConfig
                 return reinterpret_cast<const clap_event_header_t *>(data);
             }
         };
-        sst::cpputils::SimpleRingBuffer<evtCopy, 4096> eventBuf;
+        sst::conduit::shared::SPSCQueue<evtCopy, 4096> eventBuf;
 
         unsigned char eventData[maxEventSize * maxEvents];
         void writeEventTo(const clap_event_header_t *e)
@@ -100,6 +100,17 @@ struct ConduitMIDI2SawSynth
         return true;
     }
 
+    // The event ring is the only big thing here; the editor pops it on this thread too
+    void deactivate() noexcept override
+    {
+        if (releaseDSPMemory())
+        {
+            auto &q = uiComms.dataCopyForUI.eventBuf;
+            q.clear();
+            shared::DSPArena::discardRange(q.storage(), q.storageBytes);
+        }
+    }
+
     enum paramIds : uint32_t
     {
         pmStepped = 24842,
@@ -150,7 +161,9 @@ struct ConduitMIDI2SawSynth
     };
 
   protected:
+#if !defined(CONDUIT_HEADLESS)
     std::unique_ptr<juce::Component> createEditor() override;
+#endif
     std::atomic<bool> refreshUIValues{false};
 
   public:
@@ -65,17 +65,26 @@ struct ConduitMTSToNoteExpressionEditor : public sst::jucegui::accessibility::Ig
             }
         });
 
+        auto ic = std::make_unique<InfoComp>(this);
+        infoComp = ic.get();
         statusPanel = std::make_unique<jcmp::NamedPanel>("Status");
-        statusPanel->setContentAreaComponent(std::make_unique<InfoComp>(this));
+        statusPanel->setContentAreaComponent(std::move(ic));
         addAndMakeVisible(*statusPanel);
 
         controlsPanel = std::make_unique<jcmp::NamedPanel>("Controls");
         addAndMakeVisible(*controlsPanel);
 
+        auto nc = std::make_unique<NotesComp>(this);
+        notesComp = nc.get();
         notesPanel = std::make_unique<jcmp::NamedPanel>("Notes");
-        notesPanel->setContentAreaComponent(std::make_unique<NotesComp>(this));
+        notesPanel->setContentAreaComponent(std::move(nc));
         addAndMakeVisible(*notesPanel);
 
+        // The panel chrome is cached; note and status changes only redraw the text areas
+        statusPanel->setBufferedToImage(true);
+        controlsPanel->setBufferedToImage(true);
+        notesPanel->setBufferedToImage(true);
+
         setSize(600, 400);
     }
 
@@ -104,11 +113,12 @@ struct ConduitMTSToNoteExpressionEditor : public sst::jucegui::accessibility::Ig
         if (lastNoteUpd != uic.dataCopyForUI.noteRemainingUpdate)
         {
             lastNoteUpd = uic.dataCopyForUI.noteRemainingUpdate;
-            repaint();
+            notesComp->repaint();
+            infoComp->repaint();
         }
         if (sn != scaleName)
         {
-            repaint();
+            infoComp->repaint();
         }
     }
 
@@ -193,6 +203,8 @@ struct ConduitMTSToNoteExpressionEditor : public sst::jucegui::accessibility::Ig
             notesPanel->setBounds(getLocalBounds().withTrimmedTop(th));
     }
     std::unique_ptr<jcmp::NamedPanel> statusPanel, controlsPanel, notesPanel;
+    InfoComp *infoComp{nullptr};
+    NotesComp *notesComp{nullptr};
     juce::Typeface::Ptr fixedFace{nullptr};
 
     std::string scaleName{""};
@@ -20,7 +20,9 @@
  */
 
 #include "mts-to-noteexpression.h"
+#if !defined(CONDUIT_HEADLESS)
 #include "juce_gui_basics/juce_gui_basics.h"
+#endif
 #include "version.h"
 
 #include "libMTSClient.h"
@@ -75,10 +77,10 @@ ConduitMTSToNoteExpression::ConduitMTSToNoteExpression(const clap_host *host)
     attachParam(pmReleaseTuning, postNoteRelease);
     attachParam(pmRetuneHeld, retunHeld);
 
-    clapJuceShim = std::make_unique<sst::clap_juce_shim::ClapJuceShim>(this);
-    clapJuceShim->setResizable(true);
+    setupEditorShim(true);
 
     uiComms.dataCopyForUI.mtsClient = mtsClient;
+    streamedTuning = &tuning;
 }
 
 ConduitMTSToNoteExpression::~ConduitMTSToNoteExpression() {}
@@ -96,6 +98,8 @@ bool ConduitMTSToNoteExpression::notePortsInfo(uint32_t index, bool isInput,
 
 float ConduitMTSToNoteExpression::retuningFor(int key, int channel) const
 {
+    if (tuning.isRetuned())
+        return tuning.current().retuningFor(key, channel);
     return MTS_RetuningInSemitones(mtsClient, key, channel);
 }
 
@@ -104,12 +108,18 @@ bool ConduitMTSToNoteExpression::retuneHeldNotes() { return (*retunHeld > 0.5);
 
 clap_process_status ConduitMTSToNoteExpression::process(const clap_process *process) noexcept
 {
+    auto frBlock = flightRecorder.scopedBlock(process);
+    auto trBlock = traceScope("process");
+
     auto ev = process->in_events;
     auto ov = process->out_events;
     auto sz = ev->size(ev);
 
-    // Generate top-of-block tuning messages for all our notes that are on
-    for (int c = 0; c < 16; ++c)
+    tuning.pickUpFromMainThread();
+
+    // Generate top-of-block tuning messages for all our notes that are on. With nothing
+    // held or releasing there is nobody to retune, so skip the 2048 note scan.
+    for (int c = 0; c < 16 && notesTracked; ++c)
     {
         for (int i = 0; i < 128; ++i)
         {
@@ -156,12 +166,18 @@ clap_process_status ConduitMTSToNoteExpression::process(const clap_process *proc
         {
             auto v = reinterpret_cast<const clap_event_param_value *>(evt);
             updateParamInPatch(v);
-            return true;
+        }
+        break;
+        case CLAP_EVENT_MIDI_SYSEX:
+        {
+            // We turn tuning messages into expressions so don't pass them on to double tune
+            auto sevt = reinterpret_cast<const clap_event_midi_sysex *>(evt);
+            if (!tuning.applySysex(sevt->buffer, sevt->size))
+                ov->try_push(ov, evt);
         }
         break;
         case CLAP_EVENT_MIDI:
         case CLAP_EVENT_MIDI2:
-        case CLAP_EVENT_MIDI_SYSEX:
         case CLAP_EVENT_NOTE_CHOKE:
             ov->try_push(ov, evt);
             break;
@@ -173,6 +189,7 @@ clap_process_status ConduitMTSToNoteExpression::process(const clap_process *proc
             assert(nevt->key >= 0);
             assert(nevt->key < 128);
             noteRemaining[nevt->channel][nevt->key] = -1;
+            notesTracked = true;
 
             auto q = clap_event_note_expression();
             q.header.size = sizeof(clap_event_note_expression);
@@ -204,6 +221,7 @@ clap_process_status ConduitMTSToNoteExpression::process(const clap_process *proc
             assert(nevt->key >= 0);
             assert(nevt->key < 128);
             noteRemaining[nevt->channel][nevt->key] = *postNoteRelease;
+            notesTracked = true;
             ov->try_push(ov, evt);
         }
         break;
@@ -229,17 +247,37 @@ clap_process_status ConduitMTSToNoteExpression::process(const clap_process *proc
         }
     }
 
+    if (!notesTracked)
+        return CLAP_PROCESS_SLEEP;
+
     // subtract block size seconds from everyone with remaining time and zero out some
+    bool anyHeld{false}, anyReleasing{false};
     for (auto &c : noteRemaining)
         for (auto &n : c)
+        {
             if (n > 0.f)
             {
                 n -= secondsPerSample * process->frames_count;
                 if (n < 0)
                     n = 0.f;
             }
+            anyHeld = anyHeld || n < 0.f;
+            anyReleasing = anyReleasing || n > 0.f;
+        }
+    notesTracked = anyHeld || anyReleasing;
 
-    return CLAP_PROCESS_CONTINUE;
+    // Keep running while a release is counting down, or while held notes could be retuned
+    // by an MTS-ESP master underneath us. Otherwise the next note or sysex wakes us.
+    if (anyReleasing || (anyHeld && retuneHeldNotes()))
+        return CLAP_PROCESS_CONTINUE;
+
+    if (!notesTracked)
+    {
+        // Leave the UI showing the final, empty, state rather than the last 1-in-16 copy
+        uiComms.dataCopyForUI.noteRemaining = noteRemaining;
+        uiComms.dataCopyForUI.noteRemainingUpdate++;
+    }
+    return CLAP_PROCESS_SLEEP;
 }
 
 } // namespace sst::conduit::mts_to_noteexpression
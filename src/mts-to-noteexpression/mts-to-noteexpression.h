@@ -111,9 +111,12 @@ struct ConduitMTSToNoteExpression
     typedef std::unordered_map<int, int> PatchPluginExtension;
 
     MTSClient *mtsClient{nullptr};
+    // A local scale or MTS sysex wins over the MTS-ESP master. See local-tuning.h
+    sst::conduit::shared::LocalTuning tuning;
     char priorScaleName[CLAP_NAME_SIZE];
     std::array<std::array<float, 128>, 16>
         noteRemaining{}; // -1 means still held, otherwise its the time
+    bool notesTracked{false}; // is anything in noteRemaining non-zero
     std::array<std::array<double, 128>, 16> sclTuning;
 
     int lastUIUpdate{0};
@@ -127,7 +130,9 @@ struct ConduitMTSToNoteExpression
     double secondsPerSample{0};
 
   protected:
+#if !defined(CONDUIT_HEADLESS)
     std::unique_ptr<juce::Component> createEditor() override;
+#endif
     std::atomic<bool> refreshUIValues{false};
 
     uint64_t samplePos{0};
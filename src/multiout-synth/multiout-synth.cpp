@@ -20,7 +20,9 @@
  */
 
 #include "multiout-synth.h"
+#if !defined(CONDUIT_HEADLESS)
 #include "juce_gui_basics/juce_gui_basics.h"
+#endif
 #include "version.h"
 
 #include "sst/cpputils/constructors.h"
@@ -93,8 +95,7 @@ ConduitMultiOutSynth::ConduitMultiOutSynth(const clap_host *host)
         attachParam(pmMute0 + i, chans[i].mute);
     }
 
-    clapJuceShim = std::make_unique<sst::clap_juce_shim::ClapJuceShim>(this);
-    clapJuceShim->setResizable(true);
+    setupEditorShim(true);
 }
 
 ConduitMultiOutSynth::~ConduitMultiOutSynth() {}
@@ -135,6 +136,9 @@ bool ConduitMultiOutSynth::notePortsInfo(uint32_t index, bool isInput,
 
 clap_process_status ConduitMultiOutSynth::process(const clap_process *process) noexcept
 {
+    auto frBlock = flightRecorder.scopedBlock(process);
+    auto trBlock = traceScope("process");
+
     auto ev = process->in_events;
     auto sz = ev->size(ev);
 
@@ -146,6 +150,22 @@ clap_process_status ConduitMultiOutSynth::process(const clap_process *process) n
         nextEvent = ev->get(ev, nextEventIndex);
     }
 
+    // Port activation can change mid-stream, so take one consistent view per block. An
+    // inactive channel is frozen where it was. Hosts owe us no particular contents in an
+    // output buffer, so clear it before flagging it constant; that is all it costs.
+    std::array<bool, nOuts> active;
+    for (auto &c : chans)
+    {
+        auto &out = process->audio_outputs[c.chan];
+        active[c.chan] = isAudioOutputActive(c.chan);
+        out.constant_mask = active[c.chan] ? 0 : 0x3;
+        if (!active[c.chan])
+        {
+            for (auto ch = 0U; ch < out.channel_count; ++ch)
+                memset(out.data32[ch], 0, process->frames_count * sizeof(float));
+        }
+    }
+
     for (auto s = 0U; s < process->frames_count; ++s)
     {
         while (nextEvent && nextEvent->time == s)
@@ -160,6 +180,9 @@ clap_process_status ConduitMultiOutSynth::process(const clap_process *process) n
 
         for (auto &c : chans)
         {
+            if (!active[c.chan])
+                continue;
+
             c.env.process(0.0, 0.1, 0.1, 0.1, 0, 0, 0, true);
             c.timeSinceTrigger += sampleRateInv;
             if (c.timeSinceTrigger > *(c.time))
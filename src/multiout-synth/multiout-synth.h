@@ -91,6 +91,9 @@ struct ConduitMultiOutSynth
     bool audioPortsInfo(uint32_t index, bool isInput,
                         clap_audio_port_info *info) const noexcept override;
 
+    // Unrouted aux outputs cost a buffer clear; see ClapBaseClass::isAudioOutputActive
+    bool implementsAudioPortsActivation() const noexcept override { return true; }
+
     bool implementsNotePorts() const noexcept override { return true; }
     uint32_t notePortsCount(bool isInput) const noexcept override { return isInput ? 1 : 0; }
     bool notePortsInfo(uint32_t index, bool isInput,
@@ -113,7 +116,9 @@ struct ConduitMultiOutSynth
     typedef std::unordered_map<int, int> PatchPluginExtension;
 
   protected:
+#if !defined(CONDUIT_HEADLESS)
     std::unique_ptr<juce::Component> createEditor() override;
+#endif
     std::atomic<bool> refreshUIValues{false};
 
     struct Chan
@@ -132,7 +137,7 @@ struct ConduitMultiOutSynth
   public:
     inline float envelope_rate_linear_nowrap(float f)
     {
-        return blockSize * sampleRateInv * pow(2.f, -f);
+        return blockSize * envelopeRates->rateLinear(f);
     }
 
   public:
@@ -54,19 +54,27 @@ struct StatusPanel : juce::Component
     StatusPanel(uicomm_t &p, ConduitPolymetricDelayEditor &e);
     ~StatusPanel();
 
+    // Only the tempo value changes, so the idle handler repaints just that line
+    juce::Rectangle<int> tempoValueBounds() const
+    {
+        return getLocalBounds().withHeight(20).translated(0, 20);
+    }
+    double paintedTempo{-1};
+    void updateIfTempoChanged()
+    {
+        if (paintedTempo != uic.dataCopyForUI.tempo)
+            repaint(tempoValueBounds());
+    }
+
     void paint(juce::Graphics &g) override
     {
-        {
-            std::ostringstream oss;
-
-            auto bx = getLocalBounds().withHeight(20);
-            g.setColour(juce::Colours::white);
-            g.setFont(14);
-            g.drawText("Tempo", bx, juce::Justification::topLeft);
-            bx = bx.translated(0, bx.getHeight());
-            g.drawText(fmt::format("{:.1f} bpm", 1.0 * uic.dataCopyForUI.tempo), bx,
-                       juce::Justification::topLeft);
-        }
+        paintedTempo = uic.dataCopyForUI.tempo;
+
+        g.setColour(juce::Colours::white);
+        g.setFont(14);
+        g.drawText("Tempo", getLocalBounds().withHeight(20), juce::Justification::topLeft);
+        g.drawText(fmt::format("{:.1f} bpm", paintedTempo), tempoValueBounds(),
+                   juce::Justification::topLeft);
     }
 };
 
@@ -163,6 +171,13 @@ struct ConduitPolymetricDelayEditor : public sst::jucegui::accessibility::Ignore
             tapPanels[i] = std::make_unique<TapPanel>(uic, *this, i);
             addAndMakeVisible(*tapPanels[i]);
         }
+
+        // Panel frames and labels are static; the meters and knobs inside invalidate
+        // only their own area of the cached image when they repaint
+        for (auto &tp : tapPanels)
+            tp->setBufferedToImage(true);
+        statusPanel->setBufferedToImage(true);
+        outputPanel->setBufferedToImage(true);
         setSize(860, 380);
 
         comms->startProcessing();
@@ -204,7 +219,7 @@ StatusPanel::StatusPanel(uicomm_t &p, ConduitPolymetricDelayEditor &e) : uic(p),
 {
     ed.comms->addIdleHandler("repaintStatus", [w = juce::Component::SafePointer(this)]() {
         if (w)
-            w->repaint();
+            w->updateIfTempoChanged();
     });
 }
 StatusPanel::~StatusPanel() { ed.comms->removeIdleHandler("repaintStatus"); }
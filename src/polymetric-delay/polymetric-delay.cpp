@@ -42,9 +42,29 @@ const clap_plugin_descriptor *ConduitPolymetricDelayConfig::getDescription()
     return &desc;
 }
 
-ConduitPolymetricDelay::ConduitPolymetricDelay(const clap_host *host)
+const clap_plugin_descriptor *ConduitPolymetricDelayConfig::getShortDescription()
+{
+    static const char *features[] = {CLAP_PLUGIN_FEATURE_AUDIO_EFFECT, CLAP_PLUGIN_FEATURE_DELAY,
+                                     nullptr};
+    static clap_plugin_descriptor desc = {CLAP_VERSION,
+                                          "org.surge-synth-team.conduit.polymetric-delay-4s",
+                                          "Conduit Polymetric Delay 4s",
+                                          "Surge Synth Team",
+                                          "https://surge-synth-team.org",
+                                          "",
+                                          "",
+                                          sst::conduit::build::FullVersionStr,
+                                          "The Conduit Polymetric Delay with short delay lines",
+                                          &features[0]};
+    return &desc;
+}
+
+ConduitPolymetricDelay::ConduitPolymetricDelay(const clap_host *host, bool shortBuffer)
     : sst::conduit::shared::ClapBaseClass<ConduitPolymetricDelay, ConduitPolymetricDelayConfig>(
-          host)
+          shortBuffer ? ConduitPolymetricDelayConfig::getShortDescription()
+                      : ConduitPolymetricDelayConfig::getDescription(),
+          host),
+      shortBuffer(shortBuffer)
 {
     auto autoFlag = CLAP_PARAM_IS_AUTOMATABLE;
     auto modFlag = autoFlag | CLAP_PARAM_IS_MODULATABLE;
@@ -58,6 +78,17 @@ ConduitPolymetricDelay::ConduitPolymetricDelay(const clap_host *host)
                                     .withGroupName("Main")
                                     .withDefault(0.5)
                                     .withFlags(modFlag));
+    paramDescriptions.push_back(ParamDesc()
+                                    .asInt()
+                                    .withID(pmDelayStorage)
+                                    .withName("Delay Line Storage")
+                                    .withGroupName("Main")
+                                    .withRange(storeFullPrecision, storeInt16)
+                                    .withDefault(storeFullPrecision)
+                                    .withFlags(CLAP_PARAM_IS_STEPPED)
+                                    .withUnorderedMapFormatting(
+                                        {{storeFullPrecision, "32 Bit Float"},
+                                         {storeInt16, "16 Bit Noise Shaped (Long Delays)"}}));
 
     for (int i = 0; i < nTaps; ++i)
     {
@@ -155,7 +186,10 @@ ConduitPolymetricDelay::ConduitPolymetricDelay(const clap_host *host)
 
     configureParams();
 
+    flightRecorder.stateNames = {"int16_storage", "", "", ""};
+
     attachParam(pmDryLevel, dryLev);
+    attachParam(pmDelayStorage, delayStorage);
 
     for (int i = 0; i < nTaps; ++i)
     {
@@ -180,11 +214,88 @@ ConduitPolymetricDelay::ConduitPolymetricDelay(const clap_host *host)
     recalcTaps();
     recalcModulators();
 
-    clapJuceShim = std::make_unique<sst::clap_juce_shim::ClapJuceShim>(this);
-    clapJuceShim->setResizable(false);
+    setupEditorShim(false);
 }
 
-ConduitPolymetricDelay::~ConduitPolymetricDelay() {}
+ConduitPolymetricDelay::~ConduitPolymetricDelay() { dspArena.release(); }
+
+bool ConduitPolymetricDelay::allocateDelayLines()
+{
+    storeAsInt16 = (int)std::round(*delayStorage) == storeInt16;
+
+    clearDelayLines();
+
+    activeDlSize = dlSize;
+    auto maxTap = (double)(dlSize - sincMargin);
+    if (shortBuffer)
+    {
+        maxTap = std::min(maxTap, shortSeconds * sampleRate);
+        for (auto sz : {shortDlSize, midDlSize, dlSize})
+        {
+            if (maxTap <= sz - sincMargin)
+            {
+                activeDlSize = sz;
+                break;
+            }
+        }
+    }
+    maxTapSamples = (float)maxTap;
+
+    bool res{false};
+    withDelayLines([&](auto &lines) { res = makeDelayLines(lines); });
+    return res;
+}
+
+template <typename DL> bool ConduitPolymetricDelay::makeDelayLines(std::array<DL *, 2> &lines)
+{
+    auto need = shared::DSPArena::footprint<DL>(2);
+    if (!dspArena.reserve(need))
+    {
+        CNDOUT << "Unable to reserve " << need << " bytes for the delay lines" << std::endl;
+        return false;
+    }
+
+    for (int c = 0; c < 2; ++c)
+        lines[c] = dspArena.make<DL>(st);
+    return true;
+}
+
+/*
+ * Run a few blocks of silence through the taps at activate, on the main thread, so the
+ * read and filter code and the sinc table are warm when the host starts processing.
+ */
+void ConduitPolymetricDelay::warmUp()
+{
+    static constexpr uint32_t frames{256};
+    static constexpr int warmUpBlocks{16};
+
+    float silence alignas(16)[2][frames]{}, scratch alignas(16)[2][frames]{};
+    float *in[2]{silence[0], silence[1]};
+    float *out[2]{scratch[0], scratch[1]};
+
+    clap_input_events noEvents{};
+    noEvents.size = [](auto) { return 0U; };
+    noEvents.get = [](auto, auto) -> const clap_event_header_t * { return nullptr; };
+
+    clap_process p{};
+    p.frames_count = frames;
+    p.in_events = &noEvents;
+
+    for (int b = 0; b < warmUpBlocks; ++b)
+    {
+        withDelayLines([&](auto &lines) { processAudio(lines, &p, in, out, 2); });
+    }
+}
+
+void ConduitPolymetricDelay::requestRestartIfStorageChanged()
+{
+    // The storage is chosen at activate, so a change while active needs a host restart
+    auto want = (int)std::round(*delayStorage) == storeInt16;
+    if (isActive() && want != storeAsInt16)
+    {
+        _host.requestRestart();
+    }
+}
 
 bool ConduitPolymetricDelay::audioPortsInfo(uint32_t index, bool isInput,
                                             clap_audio_port_info *info) const noexcept
@@ -217,16 +328,17 @@ bool ConduitPolymetricDelay::audioPortsInfo(uint32_t index, bool isInput,
 
 clap_process_status ConduitPolymetricDelay::process(const clap_process *process) noexcept
 {
-    while (!uiComms.fromUiQ.empty())
-    {
-        auto r = *uiComms.fromUiQ.pop();
+    auto frBlock = flightRecorder.scopedBlock(process);
+    auto trBlock = traceScope("process");
+
+    drainFromUIQueue([this, process](const FromUI &r) {
         generateOutputMessagesFromUI(r, process->out_events);
         if (r.type == FromUI::ADJUST_VALUE)
         {
             doValueUpdate(r.id, r.value);
             specificParamChange(r.id, r.value);
         }
-    }
+    });
     refreshUIIfNeeded();
 
     if (process->audio_outputs_count <= 0)
@@ -244,6 +356,30 @@ clap_process_status ConduitPolymetricDelay::process(const clap_process *process)
     if (chans < 2)
         return CLAP_PROCESS_SLEEP;
 
+    flightRecorder.setState(0, storeAsInt16);
+    withDelayLines([&](auto &lines) { processAudio(lines, process, in, out, chans); });
+
+    for (int c = 0; c < 2; ++c)
+    {
+        uiComms.dataCopyForUI.inVu[c] = inVU.vu_peak[c];
+        uiComms.dataCopyForUI.outVu[c] = outVU.vu_peak[c];
+        for (int t = 0; t < nTaps; ++t)
+        {
+            uiComms.dataCopyForUI.tapVu[t][c] = tapOutVU[t].vu_peak[c];
+        }
+    }
+
+    return CLAP_PROCESS_CONTINUE;
+}
+
+template <typename DL>
+void ConduitPolymetricDelay::processAudio(std::array<DL *, 2> &lines,
+                                          const clap_process *process, float **const in,
+                                          float **out, uint32_t chans)
+{
+    auto &lineL = *lines[0];
+    auto &lineR = *lines[1];
+
     auto ev = process->in_events;
     auto sz = ev->size(ev);
 
@@ -322,9 +458,10 @@ clap_process_status ConduitPolymetricDelay::process(const clap_process *process)
             tapData[tap].modulator.step();
             auto tt = baseTapSamples[tap] *
                       (1 + modDepthScale * tapData[tap].moddepth.v * tapData[tap].modulator.u);
+            tt = std::min(tt, maxTapSamples);
 
-            auto smpL = delayLine[0].read(tt);
-            auto smpR = delayLine[1].read(tt);
+            auto smpL = lineL.read(tt);
+            auto smpR = lineR.read(tt);
 
             auto dL = smpL * tapPanMatrix[tap][0] + smpR * tapPanMatrix[tap][2];
             auto dR = smpR * tapPanMatrix[tap][1] + smpL * tapPanMatrix[tap][3];
@@ -351,25 +488,13 @@ clap_process_status ConduitPolymetricDelay::process(const clap_process *process)
         {
             out[c][i] = in[c][i] * dl + totalTapOut[c];
 
-            delayLine[c].write(in[c][i] + totalTapFB[c]);
+            lines[c]->write(in[c][i] + totalTapFB[c]);
             inMx[c] = std::max(inMx[c], std::abs(in[c][i]));
             outMx[c] = std::max(outMx[c], std::abs(out[c][i]));
         }
 
         processLags();
     }
-
-    for (int c = 0; c < 2; ++c)
-    {
-        uiComms.dataCopyForUI.inVu[c] = inVU.vu_peak[c];
-        uiComms.dataCopyForUI.outVu[c] = outVU.vu_peak[c];
-        for (int t = 0; t < nTaps; ++t)
-        {
-            uiComms.dataCopyForUI.tapVu[t][c] = tapOutVU[t].vu_peak[c];
-        }
-    }
-
-    return CLAP_PROCESS_CONTINUE;
 }
 
 void ConduitPolymetricDelay::handleInboundEvent(const clap_event_header_t *evt)
@@ -431,6 +556,11 @@ void ConduitPolymetricDelay::specificParamChange(clap_id id, float val)
     {
         recalcModulators();
     }
+
+    if (id == pmDelayStorage)
+    {
+        requestRestartIfStorageChanged();
+    }
 }
 
 void ConduitPolymetricDelay::recalcTaps()
@@ -41,11 +41,12 @@
 #include "sst/filters/BiquadFilter.h"
 
 #include "conduit-shared/clap-base-class.h"
+#include "conduit-shared/int16-sinc-delay-line.h"
 
 namespace sst::conduit::polymetric_delay
 {
 
-static constexpr int nParams = 45;
+static constexpr int nParams = 46;
 
 struct ConduitPolymetricDelayConfig
 {
@@ -70,17 +71,22 @@ struct ConduitPolymetricDelayConfig
     };
 
     static const clap_plugin_descriptor *getDescription();
+    // The same delay with short lines. See ConduitPolymetricDelay::shortBuffer
+    static const clap_plugin_descriptor *getShortDescription();
 };
 
 struct ConduitPolymetricDelay
     : sst::conduit::shared::ClapBaseClass<ConduitPolymetricDelay, ConduitPolymetricDelayConfig>
 {
-    ConduitPolymetricDelay(const clap_host *host);
+    ConduitPolymetricDelay(const clap_host *host, bool shortBuffer = false);
     ~ConduitPolymetricDelay();
 
     bool activate(double sr, uint32_t minFrameCount, uint32_t maxFrameCount) noexcept override
     {
+        auto tr = traceScope("activate");
         setSampleRate(sr);
+        if (!allocateDelayLines())
+            return false;
         recalcTaps();
         recalcModulators();
 
@@ -88,14 +94,26 @@ struct ConduitPolymetricDelay
         outVU.setSampleRate(sr);
         for (auto &t : tapOutVU)
             t.setSampleRate(sr);
+
+        prefaultDSPMemory();
+        warmUp();
         return true;
     }
 
+    // The lines are megabytes each and are rebuilt, cleared, at activate anyway
+    void deactivate() noexcept override
+    {
+        if (!releaseDSPMemory())
+            return;
+        clearDelayLines();
+    }
+
     static constexpr int nTaps{4};
     enum paramIds : uint32_t
     {
         // These set of parameters are one-per
         pmDryLevel = 81, // in dsp, in gui
+        pmDelayStorage = 93,
 
         // These set of parameters are per tap, so level on tap N = pmTapLevel + N. So you need
         // to space them by more than nTaps. I space them by 1000 here
@@ -118,6 +136,12 @@ struct ConduitPolymetricDelay
 
     inline bool isTapParam(clap_id pid, paramIds base) { return pid >= base && pid < base + nTaps; }
 
+    enum DelayStorage : uint32_t
+    {
+        storeFullPrecision = 0,
+        storeInt16 = 1
+    };
+
     bool implementsAudioPorts() const noexcept override { return true; }
     uint32_t audioPortsCount(bool isInput) const noexcept override { return 1; }
     bool audioPortsInfo(uint32_t index, bool isInput,
@@ -130,6 +154,9 @@ struct ConduitPolymetricDelay
      */
 
     clap_process_status process(const clap_process *process) noexcept override;
+    template <typename DL>
+    void processAudio(std::array<DL *, 2> &lines, const clap_process *process,
+                      float **const in, float **out, uint32_t chans);
     void handleInboundEvent(const clap_event_header_t *evt);
 
     bool startProcessing() noexcept override
@@ -171,12 +198,67 @@ struct ConduitPolymetricDelay
     // For now our strategy is to just have honkin big delay lines
     // but we want to make these adapt with max time going forward
     // This is enough for about 20 seconds of delay at 48khz
-    sst::basic_blocks::tables::SurgeSincTableProvider st{};
+    const sst::basic_blocks::tables::SurgeSincTableProvider &st{
+        shared::TableCache::get<sst::basic_blocks::tables::SurgeSincTableProvider>("surge-sinc")};
     static constexpr uint32_t dlSize{1 << 20};
-    sst::basic_blocks::dsp::SSESincDelayLine<dlSize> delayLine[2]{st, st};
+    /*
+     * The "4s" variant from the factory holds shortSeconds at whatever rate it runs. At
+     * activate it takes the shortest of these lines which fits, so 1 << 18 up to 64khz,
+     * 1 << 19 up to 128khz and the full line above that, and clamps the taps to 4 seconds.
+     */
+    static constexpr double shortSeconds{4.0};
+    static constexpr uint32_t shortDlSize{1 << 18}, midDlSize{1 << 19};
+    static constexpr uint32_t sincMargin{64};
+    const bool shortBuffer;
+    uint32_t activeDlSize{dlSize};
+
+    // Only the storage chosen at activate is allocated. Long delays are bound by memory
+    // bandwidth so the 16 bit option halves both the footprint and the bytes per tap read.
+    template <uint32_t N> struct DelayLines
+    {
+        using fullLine_t = sst::basic_blocks::dsp::SSESincDelayLine<N>;
+        using int16Line_t = sst::conduit::shared::Int16SincDelayLine<N>;
+        // Both channels live side by side in dspArena; only the active storage type is built
+        std::array<fullLine_t *, 2> full{};
+        std::array<int16Line_t *, 2> int16{};
+    };
+    DelayLines<dlSize> longLines;
+    DelayLines<midDlSize> midLines;
+    DelayLines<shortDlSize> shortLines;
+    bool storeAsInt16{false};
+    // Taps and their modulation are clamped inside the line, leaving room for the sinc
+    float maxTapSamples{0};
+    template <typename DL> bool makeDelayLines(std::array<DL *, 2> &lines);
+    void clearDelayLines()
+    {
+        longLines = {};
+        midLines = {};
+        shortLines = {};
+    }
+    template <typename F> void withDelayLines(F &&f)
+    {
+        auto pick = [&](auto &dl) {
+            if (storeAsInt16)
+                f(dl.int16);
+            else
+                f(dl.full);
+        };
+        if (activeDlSize == shortDlSize)
+            pick(shortLines);
+        else if (activeDlSize == midDlSize)
+            pick(midLines);
+        else
+            pick(longLines);
+    }
+    float *delayStorage{nullptr};
+    bool allocateDelayLines();
+    void requestRestartIfStorageChanged();
+    void warmUp();
 
   protected:
+#if !defined(CONDUIT_HEADLESS)
     std::unique_ptr<juce::Component> createEditor() override;
+#endif
     std::atomic<bool> refreshUIValues{false};
 
     float tapPanMatrix[nTaps][4];
@@ -208,6 +290,7 @@ struct ConduitPolymetricDelay
     {
         recalcTaps();
         recalcModulators();
+        requestRestartIfStorageChanged();
     }
 
     std::array<sst::filters::Biquad::BiquadFilter<ConduitPolymetricDelay, blockSize>, nTaps> hp, lp;
@@ -46,7 +46,7 @@ struct SharedConfig
 
     static float envelopeRateLinear(GlobalStorage *g, float f)
     {
-        return blockSize * sampleRateInv(g) * pow(2.f, -f);
+        return blockSize * g->envelopeRates->rateLinear(f);
     }
     static bool isDeactivated(EffectStorage *, int) { return false; }
     static bool isExtended(EffectStorage *, int) { return false; }
@@ -0,0 +1,189 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#include "freeze.h"
+#include "polysynth.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "sst/filters/HalfRateFilter.h"
+
+namespace sst::conduit::CONDUIT_POLYSYNTH_NS
+{
+PatchFreezer::~PatchFreezer()
+{
+    shuttingDown = true;
+    cancel = true;
+    joinWorker();
+}
+
+void PatchFreezer::joinWorker()
+{
+    if (worker.joinable())
+        worker.join();
+}
+
+bool PatchFreezer::freeze()
+{
+    if (state == RENDERING || voiceRate <= 0)
+        return false;
+
+    // Attaching reads the synth's parameter maps, so do it here rather than on the worker
+    auto voice = std::make_unique<PolysynthVoice>(synth);
+    voice->attachTo(synth);
+    voice->mtsClient = nullptr;
+    voice->ignoreTuning = true;
+    voice->captureBeforeAmp = true;
+    voice->setSampleRate(voiceRate);
+
+    joinWorker();
+    cancel = false;
+    workerDone = false;
+    progress = 0.f;
+    state = RENDERING;
+    worker = std::thread([this, v = std::move(voice)]() mutable { render(std::move(v)); });
+    return true;
+}
+
+void PatchFreezer::unfreeze()
+{
+    // A render in flight finishes its zone, sees this, and hands back nothing
+    if (worker.joinable())
+        cancel = true;
+    next.reset();
+    swapPending = true;
+    trySwap();
+}
+
+void PatchFreezer::onMainThread()
+{
+    if (workerDone)
+    {
+        workerDone = false;
+        joinWorker();
+        if (rendered && !cancel)
+        {
+            next = std::move(rendered);
+            swapPending = true;
+        }
+        else
+        {
+            rendered.reset();
+            state = current ? FROZEN : LIVE;
+        }
+    }
+
+    if (retired && !retiring.load())
+        retired.reset();
+    trySwap();
+}
+
+void PatchFreezer::trySwap()
+{
+    // One retirement at a time. The audio thread calls us back when it lets the last one go.
+    if (!swapPending || retired)
+        return;
+
+    swapPending = false;
+    retired = std::move(current);
+    current = std::move(next);
+    retiring.store(retired.get());
+    published.store(current.get());
+
+    if (!worker.joinable())
+        state = current ? FROZEN : LIVE;
+    frozenBytes = current ? current->bytes() : 0;
+    frozenZones = current ? current->zones.size() : 0;
+}
+
+void PatchFreezer::render(std::unique_ptr<PolysynthVoice> voice)
+{
+    static constexpr int bs{PolysynthVoice::blockSize}, bsOS{PolysynthVoice::blockSizeOS};
+    using ms_t = FrozenMultisample;
+
+    auto res = std::make_unique<ms_t>();
+    res->sampleRate = voice->samplerate / PolysynthVariant::oversampling;
+
+    auto total = (size_t)(ms_t::renderSeconds * res->sampleRate);
+    auto loopLen = (size_t)(ms_t::loopSeconds * res->sampleRate);
+    auto xf = (size_t)(ms_t::crossfadeSeconds * res->sampleRate);
+    auto nZones = (ms_t::highKey - ms_t::lowKey) / ms_t::keyStep + 1;
+
+    for (int key = ms_t::lowKey; key <= ms_t::highKey && !cancel; key += ms_t::keyStep)
+    {
+        voice->start(0, 0, key, -1, 1.0);
+        if (key == ms_t::lowKey)
+            res->mono = voice->monoSource;
+        auto nch = res->mono ? 1 : 2;
+
+        ms_t::Zone z;
+        z.rootKey = key;
+        z.rootFreq = 440.0 * std::pow(2.0, (key - 69.0) / 12.0);
+        for (int c = 0; c < nch; ++c)
+            z.data[c].reserve(total + bs);
+
+        // Store at the host-ish rate; the voice interpolates back up at playback
+        sst::filters::HalfRate::HalfRateFilter hr(6, true);
+        float inR alignas(16)[bsOS], outL alignas(16)[bs], outR alignas(16)[bs];
+        while (z.data[0].size() < total)
+        {
+            voice->processBlock();
+            memcpy(inR, voice->outputOS[res->mono ? 0 : 1], sizeof(inR));
+            if constexpr (PolysynthVariant::oversampling == 1)
+            {
+                memcpy(outL, voice->outputOS[0], sizeof(outL));
+                memcpy(outR, inR, sizeof(outR));
+            }
+            else
+            {
+                hr.process_block_D2(voice->outputOS[0], inR, bsOS, outL, outR);
+            }
+            z.data[0].insert(z.data[0].end(), outL, outL + bs);
+            if (!res->mono)
+                z.data[1].insert(z.data[1].end(), outR, outR + bs);
+        }
+
+        // Loop the tail, fading its end into the material just before the loop point
+        z.loopStart = total - loopLen;
+        for (int c = 0; c < nch; ++c)
+        {
+            auto &d = z.data[c];
+            d.resize(total);
+            for (auto i = 0U; i < xf; ++i)
+            {
+                auto t = 1.f * i / xf;
+                auto &to = d[total - xf + i];
+                to = (1 - t) * to + t * d[z.loopStart - xf + i];
+            }
+        }
+
+        res->zones.push_back(std::move(z));
+        progress = 1.f * res->zones.size() / nZones;
+    }
+
+    if (!cancel)
+        rendered = std::move(res);
+    workerDone = true;
+    if (!shuttingDown)
+        requestMainThread();
+}
+} // namespace sst::conduit::CONDUIT_POLYSYNTH_NS
@@ -0,0 +1,145 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_POLYSYNTH_FREEZE_H
+#define CONDUIT_SRC_POLYSYNTH_FREEZE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "variant.h"
+
+namespace sst::conduit::CONDUIT_POLYSYNTH_NS
+{
+struct ConduitPolysynth;
+struct PolysynthVoice;
+
+/*
+ * A frozen patch is the voice engine up to, but not including, the amp envelope and the
+ * output stage, rendered at a spread of root keys. A frozen voice plays the nearest zone
+ * back at pitch and runs the real AEG, level, velocity and pan on it, so the envelope still
+ * follows the gate and the patch's level and pan knobs keep working. Everything upstream
+ * (oscillators, filters, waveshaper, FEG sweep, LFOs) is baked in, and each zone loops its
+ * tail once the render runs out.
+ *
+ * Velocity only reaches this engine in the output stage, which playback reuses, so one
+ * render per key is exact and there are no velocity layers.
+ */
+struct FrozenMultisample
+{
+    struct Zone
+    {
+        int rootKey{60};
+        double rootFreq{261.63};
+        std::vector<float> data[2]; // only data[0] when mono
+        size_t loopStart{0};
+
+        size_t length() const { return data[0].size(); }
+    };
+
+    double sampleRate{0}; // of the data, which is half the voice rate at render time
+    bool mono{true};
+    std::vector<Zone> zones;
+
+    const Zone &zoneFor(int key) const
+    {
+        auto idx = (size_t)std::max(0, (key - zones.front().rootKey + keyStep / 2) / keyStep);
+        return zones[std::min(idx, zones.size() - 1)];
+    }
+    size_t bytes() const
+    {
+        size_t res{0};
+        for (const auto &z : zones)
+            res += (z.data[0].size() + z.data[1].size()) * sizeof(float);
+        return res;
+    }
+
+    static constexpr int lowKey{24}, highKey{108}, keyStep{4};
+    static constexpr double renderSeconds{1.5}, loopSeconds{0.5}, crossfadeSeconds{0.05};
+};
+
+/*
+ * Owns the multisample and the hand-off to the audio thread. Rendering happens on a
+ * worker thread through a private voice attached to the synth's parameters, so the patch
+ * should be left alone while it runs. A multisample being replaced (by a new freeze or an
+ * unfreeze) is only freed once the audio thread reports that no voice still plays it.
+ */
+struct PatchFreezer
+{
+    enum State
+    {
+        LIVE,
+        RENDERING,
+        FROZEN
+    };
+
+    explicit PatchFreezer(ConduitPolysynth &s) : synth(s) {}
+    ~PatchFreezer();
+
+    // Main thread
+    bool freeze();
+    void unfreeze();
+    void onMainThread();
+    void setVoiceRate(double r) { voiceRate = r; }
+    std::function<void()> requestMainThread;
+
+    // Any thread, for display
+    std::atomic<int> state{LIVE};
+    std::atomic<float> progress{0.f};
+    std::atomic<size_t> frozenBytes{0}, frozenZones{0};
+
+    // Audio thread. Returns what new voices should play, nullptr being the live engine.
+    template <typename InUse> const FrozenMultisample *pickUp(InUse &&inUse)
+    {
+        auto cur = published.load();
+        auto r = retiring.load();
+        if (r && r != cur && !inUse(r))
+        {
+            retiring.store(nullptr);
+            requestMainThread();
+        }
+        return cur;
+    }
+
+  private:
+    ConduitPolysynth &synth;
+    double voiceRate{0};
+
+    std::thread worker;
+    std::atomic<bool> workerDone{false}, cancel{false}, shuttingDown{false};
+    std::unique_ptr<FrozenMultisample> rendered;
+    void render(std::unique_ptr<PolysynthVoice> voice);
+
+    // Owned here on the main thread; the audio thread only ever sees the raw pointers
+    std::unique_ptr<FrozenMultisample> current, next, retired;
+    bool swapPending{false};
+    std::atomic<const FrozenMultisample *> published{nullptr}, retiring{nullptr};
+    void trySwap();
+    void joinWorker();
+};
+} // namespace sst::conduit::CONDUIT_POLYSYNTH_NS
+
+#endif // CONDUIT_SRC_POLYSYNTH_FREEZE_H
@@ -0,0 +1,266 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_POLYSYNTH_NOTE_ON_SCHEDULER_H
+#define CONDUIT_SRC_POLYSYNTH_NOTE_ON_SCHEDULER_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace sst::conduit::polysynth
+{
+/*
+ * A big chord or the first beat of a midi file can deliver dozens of note ons in one
+ * process block, and each one runs the whole voice start in that block. The scheduler
+ * caps the voice starts per block. Note ons over the cap are held and started at the
+ * top of the next block, as long as that keeps them within maxDelaySamples of when they
+ * were due. Anything which would wait longer starts on time regardless of the cap.
+ *
+ * Held notes start in arrival order, or loudest first. A note off for a held note is
+ * remembered and sent right after its start, so on/off pairs survive, and so are note
+ * expressions, polyphonic modulation and chokes aimed at it. The scheduler only ever
+ * decides; the synth does the starting through the callbacks it passes in.
+ */
+struct NoteOnScheduler
+{
+    enum Mode
+    {
+        OFF = 0,
+        BY_ORDER = 1,
+        BY_VELOCITY = 2
+    };
+    static constexpr int maxPending{256};
+    static constexpr int maxFollowUps{8};
+
+    // An event for a held note, replayed once the note has started
+    struct FollowUp
+    {
+        enum Type : uint8_t
+        {
+            EXPRESSION,
+            PARAM_MOD,
+            CHOKE
+        } type{EXPRESSION};
+        uint32_t id{0}; // the expression or param id
+        double value{0};
+    };
+
+    struct Pending
+    {
+        bool isMidi{false};
+        uint8_t midi[3]{};
+        int16_t port{0}, channel{0}, key{0};
+        int32_t noteId{-1};
+        float velocity{0.f};
+
+        bool released{false};
+        uint8_t releaseMidi[3]{};
+        float releaseVelocity{0.f};
+
+        std::array<FollowUp, maxFollowUps> followUps{};
+        int nFollowUps{0};
+        bool choked{false};
+
+        uint32_t waited{0};
+        uint64_t order{0};
+    };
+
+    Mode mode{OFF};
+    int maxStartsPerBlock{8};
+    uint32_t maxDelaySamples{48};
+
+    // Running totals for the UI
+    uint32_t deferredCount{0}, longestDelaySamples{0};
+
+    void reset()
+    {
+        nPending = 0;
+        startedThisBlock = 0;
+        blockFrames = 0;
+    }
+
+    /*
+     * Called at the top of each process block. Starts held notes up to the cap, or beyond
+     * it for notes which can't wait another block of this size. Each start is start(p),
+     * then followUp(p, f) for each event recorded against it, then a CHOKE follow up or
+     * release(p) if it has been choked or let go.
+     *
+     * order is unique, so plain std::sort gives the same result as a stable sort and
+     * works in place, where std::stable_sort may allocate on the audio thread.
+     */
+    template <typename Start, typename FollowUpFn, typename Release>
+    void beginBlock(uint32_t frames, Start &&start, FollowUpFn &&followUp, Release &&release)
+    {
+        blockFrames = frames;
+        startedThisBlock = 0;
+        if (nPending == 0)
+            return;
+
+        if (mode == BY_VELOCITY)
+            std::sort(pending.begin(), pending.begin() + nPending,
+                      [](const auto &a, const auto &b) {
+                          if (a.velocity != b.velocity)
+                              return a.velocity > b.velocity;
+                          return a.order < b.order;
+                      });
+
+        int kept{0};
+        for (int i = 0; i < nPending; ++i)
+        {
+            auto &p = pending[i];
+            if (startedThisBlock < maxStartsPerBlock || mode == OFF ||
+                p.waited + frames > maxDelaySamples)
+            {
+                longestDelaySamples = std::max(longestDelaySamples, p.waited);
+                startedThisBlock++;
+                start(p);
+                for (int f = 0; f < p.nFollowUps; ++f)
+                    followUp(p, p.followUps[f]);
+                if (p.choked)
+                    followUp(p, FollowUp{FollowUp::CHOKE});
+                else if (p.released)
+                    release(p);
+            }
+            else
+            {
+                p.waited += frames;
+                pending[kept++] = p;
+            }
+        }
+        nPending = kept;
+
+        if (mode == BY_VELOCITY)
+            std::sort(pending.begin(), pending.begin() + nPending,
+                      [](const auto &a, const auto &b) { return a.order < b.order; });
+    }
+
+    // Called outside a process block (params flush) so nothing gets held
+    void noBlock() { blockFrames = 0; }
+
+    /*
+     * Ask before starting a note due at sample `time`. True means it was held and the
+     * caller should do nothing; false means start it now.
+     */
+    bool hold(const Pending &p, uint32_t time)
+    {
+        if (mode == OFF || blockFrames == 0 || startedThisBlock < maxStartsPerBlock)
+        {
+            startedThisBlock++;
+            return false;
+        }
+        auto wait = blockFrames > time ? blockFrames - time : 0;
+        if (wait > maxDelaySamples || nPending >= maxPending)
+        {
+            startedThisBlock++;
+            return false;
+        }
+
+        auto &q = pending[nPending++];
+        q = p;
+        q.waited = wait;
+        q.order = nextOrder++;
+        deferredCount++;
+        return true;
+    }
+
+    /*
+     * Ask on a note off. If it matches a held note it is recorded against that note and
+     * true is returned, so the caller drops it.
+     */
+    bool holdRelease(int16_t port, int16_t channel, int16_t key, int32_t noteId,
+                     float velocity, const uint8_t *midi = nullptr)
+    {
+        for (int i = 0; i < nPending; ++i)
+        {
+            auto &p = pending[i];
+            if (p.released || p.port != port || p.channel != channel || p.key != key)
+                continue;
+            if (noteId != -1 && p.noteId != -1 && noteId != p.noteId)
+                continue;
+
+            p.released = true;
+            p.releaseVelocity = velocity;
+            if (midi)
+                std::copy(midi, midi + 3, p.releaseMidi);
+            return true;
+        }
+        return false;
+    }
+
+    /*
+     * Ask on a note expression, note id or key targeted parameter modulation, or choke.
+     * The event is recorded against every held note it addresses. True is returned only
+     * when it names a note id which is held, so nothing playing can also want it.
+     * Expressions and modulations of the same id replace the earlier value.
+     */
+    bool holdFollowUp(int16_t port, int16_t channel, int16_t key, int32_t noteId,
+                      const FollowUp &f)
+    {
+        bool any{false};
+        for (int i = 0; i < nPending; ++i)
+        {
+            auto &p = pending[i];
+            if (noteId != -1)
+            {
+                if (p.noteId != noteId)
+                    continue;
+            }
+            else if ((port != -1 && p.port != port) || (channel != -1 && p.channel != channel) ||
+                     (key != -1 && p.key != key))
+            {
+                continue;
+            }
+
+            any = true;
+            if (p.choked)
+                continue;
+            if (f.type == FollowUp::CHOKE)
+            {
+                p.choked = true;
+                continue;
+            }
+
+            int slot{0};
+            while (slot < p.nFollowUps &&
+                   (p.followUps[slot].type != f.type || p.followUps[slot].id != f.id))
+                slot++;
+            if (slot == maxFollowUps)
+                slot = maxFollowUps - 1;
+            else if (slot == p.nFollowUps)
+                p.nFollowUps++;
+            p.followUps[slot] = f;
+        }
+        return any && noteId != -1;
+    }
+
+    int pendingCount() const { return nPending; }
+
+  private:
+    std::array<Pending, maxPending> pending{};
+    int nPending{0};
+    int startedThisBlock{0};
+    uint32_t blockFrames{0};
+    uint64_t nextOrder{0};
+};
+} // namespace sst::conduit::polysynth
+
+#endif // CONDUIT_SRC_POLYSYNTH_NOTE_ON_SCHEDULER_H
@@ -34,19 +34,20 @@
 #include "sst/jucegui/components/VUMeter.h"
 #include "sst/jucegui/components/MenuButton.h"
 #include "sst/jucegui/components/JogUpDownButton.h"
+#include "sst/jucegui/components/TextPushButton.h"
 
 #include "sst/jucegui/component-adapters/DiscreteToReference.h"
 #include "sst/jucegui/data/Continuous.h"
 #include "conduit-shared/editor-base.h"
 #include <sst/jucegui/layouts/LabeledGrid.h>
 
-namespace sst::conduit::polysynth::editor
+namespace sst::conduit::CONDUIT_POLYSYNTH_NS::editor
 {
 namespace jcmp = sst::jucegui::components;
 namespace jcad = sst::jucegui::component_adapters;
 namespace jdat = sst::jucegui::data;
 
-using cps_t = sst::conduit::polysynth::ConduitPolysynth;
+using cps_t = sst::conduit::CONDUIT_POLYSYNTH_NS::ConduitPolysynth;
 using uicomm_t = cps_t::UICommunicationBundle;
 
 struct ConduitPolysynthEditor;
@@ -325,7 +326,7 @@ struct ModMatrixPanel : jcmp::NamedPanel
             }
         }
 
-        std::array<std::unique_ptr<ModMatrixRow>, polysynth::ModMatrixConfig::nModSlots> modRows;
+        std::array<std::unique_ptr<ModMatrixRow>, ModMatrixConfig::nModSlots> modRows;
     };
 
     std::map<std::string, std::map<std::string, int32_t>> sourceMenu;
@@ -361,13 +362,21 @@ struct StatusPanel : jcmp::NamedPanel
         {
             panel->mpeButton->widget->setBounds(0, 0, 200, 20);
             panel->voiceCountLabel->setBounds(0, 22, 200, 20);
+            panel->noteOnLabel->setBounds(0, 44, 200, 20);
+            panel->freezeButton->setBounds(0, 66, 70, 20);
+            panel->freezeLabel->setBounds(74, 66, 200, 20);
             panel->vuMeter->setBounds(getWidth() - 30, 0, 30, getHeight());
         }
 
+        // Five lines of debug text, which changes with the transport
+        juce::Rectangle<int> debugInfoBounds() const
+        {
+            return getLocalBounds().withTrimmedRight(33).withHeight(12 * 5);
+        }
+
         void paint(juce::Graphics &g) override
         {
-            auto lb = getLocalBounds().withTrimmedRight(33);
-            auto bx = lb.withHeight(12);
+            auto bx = debugInfoBounds().withHeight(12);
             auto ft = juce::Font(9);
             g.setFont(ft);
             g.setColour(juce::Colours::white);
@@ -402,11 +411,22 @@ struct StatusPanel : jcmp::NamedPanel
     }
     std::unique_ptr<jcad::DiscreteToValueReference<jcmp::ToggleButton, bool>> mpeButton;
     bool mpeActive{false};
+    Content *contentWeak{nullptr};
+    int lastPolyphony{-1};
+    uint32_t lastDeferred{0};
 
     std::unique_ptr<jcmp::VUMeter> vuMeter;
     std::unique_ptr<jcmp::Label> voiceCountLabel;
+    std::unique_ptr<jcmp::Label> noteOnLabel;
+
+    std::unique_ptr<jcmp::TextPushButton> freezeButton;
+    std::unique_ptr<jcmp::Label> freezeLabel;
+    int lastFreezeState{-1};
+    int lastFreezePercent{-1};
+    void toggleFreeze();
 };
 
+#if CONDUIT_POLYSYNTH_HAS_EFFECTS
 struct ModFXPanel : jcmp::NamedPanel
 {
     uicomm_t &uic;
@@ -422,6 +442,7 @@ struct ReverbPanel : jcmp::NamedPanel
 
     ReverbPanel(uicomm_t &p, ConduitPolysynthEditor &e);
 };
+#endif
 
 struct ConduitPolysynthEditor : public sst::jucegui::accessibility::IgnoredComponent,
                                 shared::ToolTipMixIn<ConduitPolysynthEditor>
@@ -476,10 +497,12 @@ struct ConduitPolysynthEditor : public sst::jucegui::accessibility::IgnoredCompo
         statusPanel = std::make_unique<StatusPanel>(uic, *this);
         addAndMakeVisible(*statusPanel);
 
+#if CONDUIT_POLYSYNTH_HAS_EFFECTS
         modFXPanel = std::make_unique<ModFXPanel>(uic, *this);
         reverbPanel = std::make_unique<ReverbPanel>(uic, *this);
         addAndMakeVisible(*modFXPanel);
         addAndMakeVisible(*reverbPanel);
+#endif
 
         setSize(958, 550);
 
@@ -524,12 +547,17 @@ struct ConduitPolysynthEditor : public sst::jucegui::accessibility::IgnoredCompo
                                   2 * oscHeight);
 
         static constexpr int fxYPos{4 * oscHeight};
+#if CONDUIT_POLYSYNTH_HAS_EFFECTS
         static constexpr int modFXWidth{oscWidth};
         static constexpr int revFXWidth{oscWidth / 5 * 4};
         modFXPanel->setBounds(0, fxYPos, modFXWidth, oscHeight);
         reverbPanel->setBounds(modFXWidth, fxYPos, revFXWidth, oscHeight);
         statusPanel->setBounds(modFXWidth + revFXWidth, fxYPos,
                                modMatrixPanel->getRight() - (modFXWidth + revFXWidth), oscHeight);
+#else
+        // Lite has no effects, so the status runs along the whole bottom row
+        statusPanel->setBounds(0, fxYPos, modMatrixPanel->getRight(), oscHeight);
+#endif
     }
 
     std::unique_ptr<jcmp::NamedPanel> sawPanel, pulsePanel, sinPanel, noisePanel;
@@ -539,11 +567,12 @@ struct ConduitPolysynthEditor : public sst::jucegui::accessibility::IgnoredCompo
     std::unique_ptr<jcmp::NamedPanel> modMatrixPanel;
     std::unique_ptr<jcmp::NamedPanel> outputPanel, statusPanel;
 
+#if CONDUIT_POLYSYNTH_HAS_EFFECTS
     std::unique_ptr<jcmp::NamedPanel> modFXPanel, reverbPanel;
+#endif
 };
 
-SawPanel::SawPanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                   sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+SawPanel::SawPanel(uicomm_t &p, ConduitPolysynthEditor &e)
     : jcmp::NamedPanel("Saw Osc"), uic(p), ed(e)
 {
     auto content = std::make_unique<GridContentBase<ConduitPolysynthEditor, 5, 1>>();
@@ -560,8 +589,7 @@ SawPanel::SawPanel(sst::conduit::polysynth::editor::uicomm_t &p,
     setContentAreaComponent(std::move(content));
 }
 
-PulsePanel::PulsePanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                       sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+PulsePanel::PulsePanel(uicomm_t &p, ConduitPolysynthEditor &e)
     : jcmp::NamedPanel("Pulse Width Osc"), uic(p), ed(e)
 {
     auto content = std::make_unique<GridContentBase<ConduitPolysynthEditor, 5, 1>>();
@@ -578,8 +606,7 @@ PulsePanel::PulsePanel(sst::conduit::polysynth::editor::uicomm_t &p,
     setContentAreaComponent(std::move(content));
 }
 
-SinPanel::SinPanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                   sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+SinPanel::SinPanel(uicomm_t &p, ConduitPolysynthEditor &e)
     : jcmp::NamedPanel("Sin Osc"), uic(p), ed(e)
 {
     auto content = std::make_unique<GridContentBase<ConduitPolysynthEditor, 3, 1>>();
@@ -594,8 +621,7 @@ SinPanel::SinPanel(sst::conduit::polysynth::editor::uicomm_t &p,
     setContentAreaComponent(std::move(content));
 }
 
-NoisePanel::NoisePanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                       sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+NoisePanel::NoisePanel(uicomm_t &p, ConduitPolysynthEditor &e)
     : jcmp::NamedPanel("Noise OSC"), uic(p), ed(e)
 {
     auto content = std::make_unique<GridContentBase<ConduitPolysynthEditor, 2, 1>>();
@@ -609,8 +635,7 @@ NoisePanel::NoisePanel(sst::conduit::polysynth::editor::uicomm_t &p,
     setContentAreaComponent(std::move(content));
 }
 
-AEGPanel::AEGPanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                   sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+AEGPanel::AEGPanel(uicomm_t &p, ConduitPolysynthEditor &e)
     : jcmp::NamedPanel("Amplitude EG"), uic(p), ed(e)
 {
     auto content = std::make_unique<GridContentBase<ConduitPolysynthEditor, 6, 1>>();
@@ -627,8 +652,7 @@ AEGPanel::AEGPanel(sst::conduit::polysynth::editor::uicomm_t &p,
     setContentAreaComponent(std::move(content));
 }
 
-FEGPanel::FEGPanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                   sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+FEGPanel::FEGPanel(uicomm_t &p, ConduitPolysynthEditor &e)
     : jcmp::NamedPanel("Filter EG"), uic(p), ed(e)
 {
     auto content = std::make_unique<GridContentBase<ConduitPolysynthEditor, 6, 1>>();
@@ -645,8 +669,7 @@ FEGPanel::FEGPanel(sst::conduit::polysynth::editor::uicomm_t &p,
     setContentAreaComponent(std::move(content));
 }
 
-LPFPanel::LPFPanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                   sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+LPFPanel::LPFPanel(uicomm_t &p, ConduitPolysynthEditor &e)
     : jcmp::NamedPanel("Advanced Filter"), uic(p), ed(e)
 {
     auto content = std::make_unique<GridContentBase<ConduitPolysynthEditor, 4, 1>>();
@@ -665,8 +688,7 @@ LPFPanel::LPFPanel(sst::conduit::polysynth::editor::uicomm_t &p,
     setContentAreaComponent(std::move(content));
 }
 
-SVFPanel::SVFPanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                   sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+SVFPanel::SVFPanel(uicomm_t &p, ConduitPolysynthEditor &e)
     : jcmp::NamedPanel("Multi-Mode Filter"), uic(p), ed(e)
 {
     auto content = std::make_unique<GridContentBase<ConduitPolysynthEditor, 4, 1>>();
@@ -683,8 +705,7 @@ SVFPanel::SVFPanel(sst::conduit::polysynth::editor::uicomm_t &p,
     setContentAreaComponent(std::move(content));
 }
 
-WSPanel::WSPanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                 sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+WSPanel::WSPanel(uicomm_t &p, ConduitPolysynthEditor &e)
     : jcmp::NamedPanel("Waveshaper"), uic(p), ed(e)
 {
     auto content = std::make_unique<GridContentBase<ConduitPolysynthEditor, 3, 1>>();
@@ -699,8 +720,7 @@ WSPanel::WSPanel(sst::conduit::polysynth::editor::uicomm_t &p,
     setContentAreaComponent(std::move(content));
 }
 
-FilterRoutingPanel::FilterRoutingPanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                                       sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+FilterRoutingPanel::FilterRoutingPanel(uicomm_t &p, ConduitPolysynthEditor &e)
     : jcmp::NamedPanel("Filter Routing"), uic(p), ed(e)
 {
     auto content = std::make_unique<GridContentBase<ConduitPolysynthEditor, 2, 1>>();
@@ -711,8 +731,7 @@ FilterRoutingPanel::FilterRoutingPanel(sst::conduit::polysynth::editor::uicomm_t
     setContentAreaComponent(std::move(content));
 }
 
-LFOPanel::LFOPanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                   sst::conduit::polysynth::editor::ConduitPolysynthEditor &e, int which)
+LFOPanel::LFOPanel(uicomm_t &p, ConduitPolysynthEditor &e, int which)
     : jcmp::NamedPanel("LFO " + std::to_string(which + 1)), uic(p), ed(e)
 {
     auto content = std::make_unique<GridContentBase<ConduitPolysynthEditor, 4, 1>>();
@@ -748,8 +767,7 @@ LFOPanel::LFOPanel(sst::conduit::polysynth::editor::uicomm_t &p,
     setContentAreaComponent(std::move(content));
 }
 
-ModMatrixPanel::ModMatrixPanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                               sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+ModMatrixPanel::ModMatrixPanel(uicomm_t &p, ConduitPolysynthEditor &e)
     : jcmp::NamedPanel("Mod Matrix"), uic(p), ed(e)
 {
     auto content = std::make_unique<Content>();
@@ -766,7 +784,7 @@ ModMatrixPanel::ModMatrixPanel(sst::conduit::polysynth::editor::uicomm_t &p,
     targetMenu[""]["Off"] = ConduitPolysynth::pmNoModTarget;
     targetName[ConduitPolysynth::pmNoModTarget] = "-";
 
-    auto q = conduit::polysynth::ModMatrixConfig();
+    auto q = ModMatrixConfig();
     auto s = q.sourceNames;
     for (auto &pd : s)
     {
@@ -804,8 +822,7 @@ ModMatrixPanel::ModMatrixPanel(sst::conduit::polysynth::editor::uicomm_t &p,
 }
 
 ModMatrixPanel::ModMatrixRow::ModMatrixRow(
-    int row, const ModMatrixPanel &pan, sst::conduit::polysynth::editor::uicomm_t &p,
-    sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+    int row, const ModMatrixPanel &pan, uicomm_t &p, ConduitPolysynthEditor &e)
     : row(row), uic(p), panel(pan)
 {
     xLab = std::make_unique<jcmp::Label>();
@@ -997,8 +1014,7 @@ void ModMatrixPanel::ModMatrixRow::showTargetMenu()
     p.showMenuAsync(juce::PopupMenu::Options());
 }
 
-VoiceOutputPanel::VoiceOutputPanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                                   sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+VoiceOutputPanel::VoiceOutputPanel(uicomm_t &p, ConduitPolysynthEditor &e)
     : jcmp::NamedPanel("Voice Output"), uic(p), ed(e)
 {
     auto content = std::make_unique<GridContentBase<ConduitPolysynthEditor, 2, 1>>();
@@ -1007,11 +1023,11 @@ VoiceOutputPanel::VoiceOutputPanel(sst::conduit::polysynth::editor::uicomm_t &p,
     setContentAreaComponent(std::move(content));
 }
 
-StatusPanel::StatusPanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                         sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+StatusPanel::StatusPanel(uicomm_t &p, ConduitPolysynthEditor &e)
     : jcmp::NamedPanel("Global"), uic(p), ed(e)
 {
     auto content = std::make_unique<Content>(this);
+    contentWeak = content.get();
 
     mpeButton =
         std::make_unique<jcad::DiscreteToValueReference<jcmp::ToggleButton, bool>>(mpeActive);
@@ -1030,8 +1046,27 @@ StatusPanel::StatusPanel(sst::conduit::polysynth::editor::uicomm_t &p,
     voiceCountLabel->setText("Voices: 0");
     content->addAndMakeVisible(*voiceCountLabel);
 
+    noteOnLabel = std::make_unique<jcmp::Label>();
+    noteOnLabel->setText("Held Note Ons: 0");
+    content->addAndMakeVisible(*noteOnLabel);
+
+    freezeButton = std::make_unique<jcmp::TextPushButton>();
+    freezeButton->setLabel("Freeze");
+    freezeButton->setOnCallback([w = juce::Component::SafePointer(this)]() {
+        if (w)
+            w->toggleFreeze();
+    });
+    content->addAndMakeVisible(*freezeButton);
+
+    freezeLabel = std::make_unique<jcmp::Label>();
+    freezeLabel->setText("Live Engine");
+    content->addAndMakeVisible(*freezeLabel);
+
     setContentAreaComponent(std::move(content));
 
+    // The frame is cached; the meter and voice count repaint only their own bounds
+    setBufferedToImage(true);
+
     ed.comms->addIdleHandler("status", [this]() { updateStatus(); });
 }
 
@@ -1040,12 +1075,70 @@ StatusPanel::~StatusPanel() { ed.comms->removeIdleHandler("status"); }
 void StatusPanel::updateStatus()
 {
     vuMeter->setLevels(uic.dataCopyForUI.mainVU[0], uic.dataCopyForUI.mainVU[1]);
-    voiceCountLabel->setText("Voices : " + std::to_string(uic.dataCopyForUI.polyphony));
-    repaint();
+    vuMeter->repaint();
+
+    int poly = uic.dataCopyForUI.polyphony;
+    if (poly != lastPolyphony)
+    {
+        lastPolyphony = poly;
+        voiceCountLabel->setText("Voices : " + std::to_string(poly));
+        voiceCountLabel->repaint();
+    }
+
+    uint32_t deferred = uic.dataCopyForUI.deferredNoteOns;
+    if (deferred != lastDeferred)
+    {
+        lastDeferred = deferred;
+        noteOnLabel->setText(fmt::format("Held Note Ons: {} (max {:.2f} ms)", deferred,
+                                         uic.dataCopyForUI.longestNoteOnDelayMs.load()));
+        noteOnLabel->repaint();
+    }
+
+    const auto &fz = *uic.dataCopyForUI.freezer;
+    int fs = fz.state;
+    int pct = (int)std::round(fz.progress * 100);
+    if (fs != lastFreezeState || (fs == PatchFreezer::RENDERING && pct != lastFreezePercent))
+    {
+        lastFreezeState = fs;
+        lastFreezePercent = pct;
+        switch (fs)
+        {
+        case PatchFreezer::LIVE:
+            freezeButton->setLabel("Freeze");
+            freezeLabel->setText("Live Engine");
+            break;
+        case PatchFreezer::RENDERING:
+            freezeButton->setLabel("Cancel");
+            freezeLabel->setText(fmt::format("Rendering {}%", pct));
+            break;
+        case PatchFreezer::FROZEN:
+            freezeButton->setLabel("Unfreeze");
+            freezeLabel->setText(fmt::format("Frozen: {} zones, {:.1f} MB", fz.frozenZones.load(),
+                                             fz.frozenBytes / (1024.0 * 1024.0)));
+            break;
+        }
+        freezeButton->repaint();
+        freezeLabel->repaint();
+    }
+    contentWeak->repaint(contentWeak->debugInfoBounds());
 }
 
-ModFXPanel::ModFXPanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                       sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+void StatusPanel::toggleFreeze()
+{
+    auto &fz = *uic.dataCopyForUI.freezer;
+    if (fz.state == PatchFreezer::LIVE)
+    {
+        if (!fz.freeze())
+            freezeLabel->setText("Activate the plugin to freeze");
+    }
+    else
+    {
+        fz.unfreeze();
+    }
+}
+
+#if CONDUIT_POLYSYNTH_HAS_EFFECTS
+ModFXPanel::ModFXPanel(uicomm_t &p, ConduitPolysynthEditor &e)
     : jcmp::NamedPanel("Modulation Effect"), uic(p), ed(e)
 {
     setTogglable(true);
@@ -1081,8 +1174,7 @@ ModFXPanel::ModFXPanel(sst::conduit::polysynth::editor::uicomm_t &p,
     setContentAreaComponent(std::move(content));
 }
 
-ReverbPanel::ReverbPanel(sst::conduit::polysynth::editor::uicomm_t &p,
-                         sst::conduit::polysynth::editor::ConduitPolysynthEditor &e)
+ReverbPanel::ReverbPanel(uicomm_t &p, ConduitPolysynthEditor &e)
     : jcmp::NamedPanel("Reverb Effect"), uic(p), ed(e)
 {
     setTogglable(true);
@@ -1099,15 +1191,15 @@ ReverbPanel::ReverbPanel(sst::conduit::polysynth::editor::uicomm_t &p,
     content->addKnob(e, ConduitPolysynth::pmRevFXMix, 3, 0, "Mix");
     setContentAreaComponent(std::move(content));
 }
+#endif
 
-} // namespace sst::conduit::polysynth::editor
-namespace sst::conduit::polysynth
+} // namespace sst::conduit::CONDUIT_POLYSYNTH_NS::editor
+namespace sst::conduit::CONDUIT_POLYSYNTH_NS
 {
 std::unique_ptr<juce::Component> ConduitPolysynth::createEditor()
 {
     uiComms.refreshUIValues = true;
-    auto innards =
-        std::make_unique<sst::conduit::polysynth::editor::ConduitPolysynthEditor>(uiComms);
+    auto innards = std::make_unique<editor::ConduitPolysynthEditor>(uiComms);
     auto editor = std::make_unique<conduit::shared::EditorBase<ConduitPolysynth>>(uiComms);
     editor->setContentComponent(std::move(innards));
 
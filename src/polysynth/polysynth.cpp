@@ -35,9 +35,11 @@
 #include "sst/basic-blocks/mechanics/block-ops.h"
 #include "sst/voicemanager/midi1_to_voicemanager.h"
 
+#if CONDUIT_POLYSYNTH_HAS_EFFECTS
 #include "effects-impl.h"
+#endif
 
-namespace sst::conduit::polysynth
+namespace sst::conduit::CONDUIT_POLYSYNTH_NS
 {
 
 const clap_plugin_descriptor *ConduitPolysynthConfig::getDescription()
@@ -57,8 +59,40 @@ const clap_plugin_descriptor *ConduitPolysynthConfig::getDescription()
     return &desc;
 }
 
+#if defined(CONDUIT_POLYSYNTH_LITE)
+const clap_plugin_descriptor *PolysynthVariant::getDescription()
+{
+    static const char *features[] = {CLAP_PLUGIN_FEATURE_INSTRUMENT,
+                                     CLAP_PLUGIN_FEATURE_SYNTHESIZER, nullptr};
+    static clap_plugin_descriptor desc = {CLAP_VERSION,
+                                          "org.surge-synth-team.conduit.polysynth-lite",
+                                          "Conduit Polysynth Lite",
+                                          "Surge Synth Team",
+                                          "https://surge-synth-team.org",
+                                          "",
+                                          "",
+                                          sst::conduit::build::FullVersionStr,
+                                          "The Conduit Polysynth with 16 voices and no effects",
+                                          &features[0]};
+    return &desc;
+}
+
+const clap_plugin_descriptor *getDescription() { return PolysynthVariant::getDescription(); }
+const clap_plugin *create(const clap_host *host)
+{
+    auto p = new ConduitPolysynth(host);
+    return p->clapPlugin();
+}
+#else
+const clap_plugin_descriptor *PolysynthVariant::getDescription()
+{
+    return ConduitPolysynthConfig::getDescription();
+}
+#endif
+
 ConduitPolysynth::ConduitPolysynth(const clap_host *host)
-    : sst::conduit::shared::ClapBaseClass<ConduitPolysynth, ConduitPolysynthConfig>(host),
+    : sst::conduit::shared::ClapBaseClass<ConduitPolysynth, ConduitPolysynthConfig>(
+          PolysynthVariant::getDescription(), host),
       gen((size_t)this), urd(0.f, 1.f), hr_dn(6, true), voiceManager(*this),
       voices{sst::cpputils::make_array<PolysynthVoice, max_voices>(*this)}
 {
@@ -276,7 +310,7 @@ ConduitPolysynth::ConduitPolysynth(const clap_host *host)
                                     .asInt()
                                     .withID(pmWSMode)
                                     .withDefault(1)
-                                    .withRange(0, 5)
+                                    .withRange(0, 6)
                                     .withName("WaveShaper Mode")
                                     .withGroupName("WaveShaper")
                                     .withFlags(steppedFlag)
@@ -287,7 +321,22 @@ ConduitPolysynth::ConduitPolysynth(const clap_host *host)
                                         {PolysynthVoice::Waveshapers::FullWaveRect, "Rectifier"},
                                         {PolysynthVoice::Waveshapers::WestcoastFold, "Fold"},
                                         {PolysynthVoice::Waveshapers::Fuzz, "Fuzz"},
+                                        {PolysynthVoice::Waveshapers::Hard, "Hard"},
                                     })); // FIXME enums
+    paramDescriptions.push_back(
+        ParamDesc()
+            .asInt()
+            .withID(pmWSAntiAlias)
+            .withName("WaveShaper Anti-Aliasing")
+            .withGroupName("WaveShaper")
+            .withRange(PolysynthVoice::OversampledOnly, PolysynthVoice::ADAASecondOrder)
+            .withDefault(PolysynthVoice::OversampledOnly)
+            .withFlags(steppedFlag)
+            .withUnorderedMapFormatting({
+                {PolysynthVoice::OversampledOnly, "Oversampling Only"},
+                {PolysynthVoice::ADAAFirstOrder, "ADAA 1st Order"},
+                {PolysynthVoice::ADAASecondOrder, "ADAA 2nd Order"},
+            }));
 
     paramDescriptions.push_back(ParamDesc()
                                     .asInt()
@@ -549,13 +598,57 @@ ConduitPolysynth::ConduitPolysynth(const clap_host *host)
                                     .withGroupName("Global")
                                     .withFlags(monoModFlag)
                                     .withDefault(1.0));
+    paramDescriptions.push_back(ParamDesc()
+                                    .asInt()
+                                    .withID(pmEngineRate)
+                                    .withName("Internal Processing Rate")
+                                    .withGroupName("Global")
+                                    .withRange(engineAtHostRate, voicesAndFXAtEngineRate)
+                                    .withDefault(engineAtHostRate)
+                                    .withFlags(CLAP_PARAM_IS_STEPPED)
+                                    .withUnorderedMapFormatting(
+                                        {{engineAtHostRate, "Host Rate"},
+                                         {voicesAtEngineRate, "Voices at 88.2/96k"},
+                                         {voicesAndFXAtEngineRate, "Voices and FX at 88.2/96k"}}));
+
+    paramDescriptions.push_back(ParamDesc()
+                                    .asInt()
+                                    .withID(pmNoteOnScheduling)
+                                    .withName("Note On Scheduling")
+                                    .withGroupName("Voice Starts")
+                                    .withRange(NoteOnScheduler::OFF, NoteOnScheduler::BY_VELOCITY)
+                                    .withDefault(NoteOnScheduler::OFF)
+                                    .withFlags(steppedFlag)
+                                    .withUnorderedMapFormatting(
+                                        {{NoteOnScheduler::OFF, "Start All At Once"},
+                                         {NoteOnScheduler::BY_ORDER, "Spread In Order"},
+                                         {NoteOnScheduler::BY_VELOCITY, "Spread Loudest First"}}));
+    paramDescriptions.push_back(ParamDesc()
+                                    .asInt()
+                                    .withID(pmNoteOnMaxStarts)
+                                    .withName("Max Voice Starts Per Block")
+                                    .withGroupName("Voice Starts")
+                                    .withRange(1, 32)
+                                    .withDefault(8)
+                                    .withFlags(steppedFlag)
+                                    .withLinearScaleFormatting("voices"));
+    paramDescriptions.push_back(ParamDesc()
+                                    .asFloat()
+                                    .withID(pmNoteOnMaxDelay)
+                                    .withName("Max Note On Delay")
+                                    .withGroupName("Voice Starts")
+                                    .withRange(0.1, 2.0)
+                                    .withDefault(1.0)
+                                    .withFlags(autoFlag)
+                                    .withLinearScaleFormatting("ms"));
 
     configureParams();
 
     terminatedVoices.reserve(max_voices * 4);
 
-    clapJuceShim = std::make_unique<sst::clap_juce_shim::ClapJuceShim>(this);
-    clapJuceShim->setResizable(true);
+    flightRecorder.stateNames = {"filter_routing", "mod_fx", "reverb", "engine_factor"};
+
+    setupEditorShim(true);
 
     mtsClient = MTS_RegisterClient();
 
@@ -571,20 +664,16 @@ ConduitPolysynth::ConduitPolysynth(const clap_host *host)
         }
     }
 
-    phaserFX = std::make_unique<PhaserFX>(this, this, this);
-    phaserFX->initialize();
-
-    flangerFX = std::make_unique<FlangerFX>(this, this, this);
-    flangerFX->initialize();
-
-    reverbFX = std::make_unique<ReverbFX>(this, this, this);
-    reverbFX->initialize();
-
     for (auto &v : voices)
     {
         v.attachTo(*this);
     }
 
+    streamedTuning = &tuning;
+
+    freezer.requestMainThread = [this]() { _host.requestCallback(); };
+    uiComms.dataCopyForUI.freezer = &freezer;
+
     patch.extension.initialize();
     uiComms.dataCopyForUI.populateMatrixView(patch.extension.modMatrixConfig);
 }
@@ -593,25 +682,102 @@ ConduitPolysynth::~ConduitPolysynth()
     if (mtsClient)
         MTS_DeregisterClient(mtsClient);
 
+#if !defined(CONDUIT_HEADLESS)
     // I *think* this is a bitwig bug that they won't call guiDestroy if destroying a plugin
     // with an open window but
     if (clapJuceShim)
         guiDestroy();
+#endif
+
+    // The effects point back at us so tear them down while we are still whole
+    dspArena.release();
 }
 
 bool ConduitPolysynth::activate(double sampleRate, uint32_t minFrameCount,
                                 uint32_t maxFrameCount) noexcept
 {
-    setSampleRate(sampleRate);
+    auto tr = traceScope("activate");
+    /*
+     * At high session rates the voices don't need to run at twice the host rate, so
+     * optionally pick an integer fraction of it at or under maxEngineRate and upsample
+     * once at the output. The base sample rate is whatever the effects run at.
+     */
+    activeEngineRateMode = (int)std::round(*paramToValue[pmEngineRate]);
+    engineRestartRequested = false;
+    auto factor = activeEngineRateMode == engineAtHostRate
+                      ? 1
+                      : shared::PolyphaseUpsampler::factorFor(sampleRate, maxEngineRate);
+    auto engineRate = sampleRate / factor;
+    fxAtEngineRate = factor > 1 && activeEngineRateMode == voicesAndFXAtEngineRate;
+    auto priorLatency = engineUpsampler.latency();
+    engineUpsampler.configure(factor);
+    if (engineUpsampler.latency() != priorLatency && _host.canUseLatency())
+        _host.latencyChanged();
+    hostSampleRate = sampleRate;
+    noteOnScheduler.reset();
+    blockPos = 0;
+    hostBlockPos = 0;
+
+    setSampleRate(fxAtEngineRate ? engineRate : sampleRate);
+    flightRecorder.sampleRate = sampleRate; // deadlines are always against the host block
     for (auto &v : voices)
-        v.setSampleRate(sampleRate * 2); // run voices oversampled
+        v.setSampleRate(engineRate * PolysynthVariant::oversampling);
+    freezer.setVoiceRate(engineRate * PolysynthVariant::oversampling);
+
+    if (factor > 1)
+        CNDOUT << "Polysynth engine at " << engineRate << " for host rate " << sampleRate
+               << (fxAtEngineRate ? " with fx" : "") << std::endl;
+
+    mainVU.setSampleRate(this->sampleRate);
+
+#if CONDUIT_POLYSYNTH_HAS_EFFECTS
+    /*
+     * The effects carry all their line and buffer state inline, so build them next to each
+     * other in the instance arena. The voices already sit contiguously in the synth itself.
+     */
+    phaserFX = nullptr;
+    flangerFX = nullptr;
+    reverbFX = nullptr;
+    auto need = shared::DSPArena::footprint<PhaserFX>() + shared::DSPArena::footprint<FlangerFX>() +
+                shared::DSPArena::footprint<ReverbFX>();
+    if (!dspArena.reserve(need))
+        return false;
+
+    phaserFX = dspArena.make<PhaserFX>(this, this, this);
+    flangerFX = dspArena.make<FlangerFX>(this, this, this);
+    reverbFX = dspArena.make<ReverbFX>(this, this, this);
+
+    phaserFX->initialize();
+    flangerFX->initialize();
+    reverbFX->initialize();
     phaserFX->onSampleRateChanged();
     flangerFX->onSampleRateChanged();
     reverbFX->onSampleRateChanged();
-    mainVU.setSampleRate(sampleRate);
+#endif
+
+    prefaultDSPMemory();
+    warmUp();
     return true;
 }
 
+/*
+ * Hand the effects and the voices' comb lines back while we are off; activate rebuilds the
+ * one and the comb lines are cleared whenever a voice starts its filter.
+ */
+void ConduitPolysynth::deactivate() noexcept
+{
+    if (!releaseDSPMemory())
+        return;
+
+#if CONDUIT_POLYSYNTH_HAS_EFFECTS
+    phaserFX = nullptr;
+    flangerFX = nullptr;
+    reverbFX = nullptr;
+#endif
+    for (auto &v : voices)
+        shared::DSPArena::discardRange(v.delayBufferData, sizeof(v.delayBufferData));
+}
+
 /*
  * Stereo out, Midi in, in a pretty obvious way.
  * The only trick is the idi in also has NOTE_DIALECT_CLAP which provides us
@@ -666,6 +832,9 @@ bool ConduitPolysynth::notePortsInfo(uint32_t index, bool isInput,
  */
 clap_process_status ConduitPolysynth::process(const clap_process *process) noexcept
 {
+    auto frBlock = flightRecorder.scopedBlock(process);
+    auto trBlock = traceScope("process");
+
     // If I have no outputs, do nothing
     if (process->audio_outputs_count <= 0)
         return CLAP_PROCESS_SLEEP;
@@ -678,7 +847,13 @@ clap_process_status ConduitPolysynth::process(const clap_process *process) noexc
      */
     auto ct = handleEventsFromUIQueue(process->out_events);
     if (ct)
+    {
         pushParamsToVoices();
+        requestRestartIfEngineRateChanged();
+    }
+    if (tuning.pickUpFromMainThread())
+        retuneVoices();
+    frozen = freezer.pickUp([this](auto *ms) { return anyVoicePlaying(ms); });
 
     /*
      * Stage 2: Create the AUDIO output and process events
@@ -721,10 +896,32 @@ clap_process_status ConduitPolysynth::process(const clap_process *process) noexc
             (tev->flags & CLAP_TRANSPORT_IS_PLAYING) || (tev->flags & CLAP_TRANSPORT_IS_RECORDING);
     }
 
-    bool modActive = *paramToValue[pmModFXActive] > 0.5;
-    bool revActive = *paramToValue[pmRevFXActive] > 0.5;
+    noteOnScheduler.mode =
+        (NoteOnScheduler::Mode)(int)std::round(*paramToValue[pmNoteOnScheduling]);
+    noteOnScheduler.maxStartsPerBlock = (int)std::round(*paramToValue[pmNoteOnMaxStarts]);
+    noteOnScheduler.maxDelaySamples =
+        (uint32_t)(*paramToValue[pmNoteOnMaxDelay] * 0.001 * hostSampleRate);
+    noteOnScheduler.beginBlock(
+        process->frames_count, [this](const auto &p) { startHeldNote(p); },
+        [this](const auto &p, const auto &f) { applyHeldFollowUp(p, f); },
+        [this](const auto &p) { releaseHeldNote(p); });
+
+    bool modActive = CONDUIT_POLYSYNTH_HAS_EFFECTS && *paramToValue[pmModFXActive] > 0.5;
+    bool revActive = CONDUIT_POLYSYNTH_HAS_EFFECTS && *paramToValue[pmRevFXActive] > 0.5;
     bool usePhaser = *paramToValue[pmModFXType] < 0.5;
 
+    // With a reduced engine rate, feed the upsampler one engine sample, rendering as needed
+    auto pushEngineSample = [&](bool withEffects) {
+        if (blockPos == 0)
+        {
+            renderVoices();
+            if (withEffects)
+                processEffects(output, modActive, revActive, usePhaser);
+        }
+        engineUpsampler.push(output[0][blockPos], output[1][blockPos]);
+        blockPos = (blockPos + 1) & (PolysynthVoice::blockSize - 1);
+    };
+
     for (auto i = 0U; i < process->frames_count; ++i)
     {
         // Do I have an event to process. Note that multiple events
@@ -741,32 +938,41 @@ clap_process_status ConduitPolysynth::process(const clap_process *process) noexc
                 nextEvent = ev->get(ev, nextEventIndex);
         }
 
-        if (blockPos == 0)
+        if (engineUpsampler.factor == 1)
         {
-            renderVoices();
-            if (modActive)
+            if (blockPos == 0)
             {
-                if (usePhaser)
-                {
-                    phaserFX->processBlock(output[0], output[1]);
-                }
-                else
-                {
-                    flangerFX->processBlock(output[0], output[1]);
-                }
+                renderVoices();
+                processEffects(output, modActive, revActive, usePhaser);
             }
-            if (revActive)
+            out[0][i] = output[0][blockPos];
+            out[1][i] = output[1][blockPos];
+
+            blockPos = (blockPos + 1) & (PolysynthVoice::blockSize - 1);
+        }
+        else if (fxAtEngineRate)
+        {
+            if (engineUpsampler.needsInput())
+                pushEngineSample(true);
+            engineUpsampler.pop(out[0][i], out[1][i]);
+        }
+        else
+        {
+            if (hostBlockPos == 0)
             {
-                reverbFX->processBlock(output[0], output[1]);
+                for (auto s = 0U; s < PolysynthVoice::blockSize; ++s)
+                {
+                    if (engineUpsampler.needsInput())
+                        pushEngineSample(false);
+                    engineUpsampler.pop(hostBlock[0][s], hostBlock[1][s]);
+                }
+                processEffects(hostBlock, modActive, revActive, usePhaser);
             }
-            mainVU.process<PolysynthVoice::blockSize>(output[0], output[1]);
-            uiComms.dataCopyForUI.mainVU[0] = mainVU.vu_peak[0];
-            uiComms.dataCopyForUI.mainVU[1] = mainVU.vu_peak[1];
-        }
-        out[0][i] = output[0][blockPos];
-        out[1][i] = output[1][blockPos];
+            out[0][i] = hostBlock[0][hostBlockPos];
+            out[1][i] = hostBlock[1][hostBlockPos];
 
-        blockPos = (blockPos + 1) & (PolysynthVoice::blockSize - 1);
+            hostBlockPos = (hostBlockPos + 1) & (PolysynthVoice::blockSize - 1);
+        }
     }
 
     /*
@@ -814,20 +1020,90 @@ clap_process_status ConduitPolysynth::process(const clap_process *process) noexc
     }
     terminatedVoices.clear();
 
+    uiComms.dataCopyForUI.deferredNoteOns = noteOnScheduler.deferredCount;
+    uiComms.dataCopyForUI.longestNoteOnDelayMs =
+        1000.f * noteOnScheduler.longestDelaySamples / hostSampleRate;
+
+    flightRecorder.setVoices(uiComms.dataCopyForUI.polyphony);
+    flightRecorder.setState(0, *paramToValue[pmFilterRouting]);
+    flightRecorder.setState(1, modActive ? 1 + !usePhaser : 0);
+    flightRecorder.setState(2, revActive);
+    flightRecorder.setState(3, engineUpsampler.factor);
+
     // We should have gotten all the events
     assert(!nextEvent);
 
     return CLAP_PROCESS_CONTINUE;
 }
 
+void ConduitPolysynth::processEffects(float (&buffer)[2][PolysynthVoice::blockSize],
+                                      bool modActive, bool revActive, bool usePhaser)
+{
+    auto tr = traceScope("effects");
+#if CONDUIT_POLYSYNTH_HAS_EFFECTS
+    if (modActive)
+    {
+        if (usePhaser)
+        {
+            phaserFX->processBlock(buffer[0], buffer[1]);
+        }
+        else
+        {
+            flangerFX->processBlock(buffer[0], buffer[1]);
+        }
+    }
+    if (revActive)
+    {
+        reverbFX->processBlock(buffer[0], buffer[1]);
+    }
+#endif
+    mainVU.process<PolysynthVoice::blockSize>(buffer[0], buffer[1]);
+    uiComms.dataCopyForUI.mainVU[0] = mainVU.vu_peak[0];
+    uiComms.dataCopyForUI.mainVU[1] = mainVU.vu_peak[1];
+}
+
+/*
+ * At activate, on the main thread, run a few idle blocks through the voice mix, every
+ * effect and the upsampler so their code, tables and buffers are warm before the first
+ * audible block. No voices are playing so it is silence in and out.
+ */
+void ConduitPolysynth::warmUp()
+{
+    static constexpr int warmUpBlocks{32};
+    for (int b = 0; b < warmUpBlocks; ++b)
+    {
+        renderVoices();
+        processEffects(output, CONDUIT_POLYSYNTH_HAS_EFFECTS, CONDUIT_POLYSYNTH_HAS_EFFECTS,
+                       b % 2 == 0);
+        if (engineUpsampler.factor > 1)
+        {
+            for (auto s = 0U; s < PolysynthVoice::blockSize; ++s)
+                engineUpsampler.push(output[0][s], output[1][s]);
+        }
+    }
+    engineUpsampler.reset();
+    blockPos = 0;
+    hostBlockPos = 0;
+}
+
 void ConduitPolysynth::renderVoices()
 {
+    auto tr = traceScope("render voices");
     memset(outputOS, 0, sizeof(outputOS));
+
+    // Mono voices hand their filter chain back to us so we can run four at once
+    std::array<PolysynthVoice *, max_voices> deferred;
+    size_t nDeferred{0};
     for (auto &v : voices)
     {
         if (v.isPlaying())
         {
-            v.processBlock();
+            v.processBlock(true);
+            if (v.filterDeferred)
+            {
+                deferred[nDeferred++] = &v;
+                continue;
+            }
             sst::basic_blocks::mechanics::accumulate_from_to<PolysynthVoice::blockSizeOS>(
                 v.outputOS[0], outputOS[0]);
             sst::basic_blocks::mechanics::accumulate_from_to<PolysynthVoice::blockSizeOS>(
@@ -835,7 +1111,29 @@ void ConduitPolysynth::renderVoices()
         }
     }
 
-    hr_dn.process_block_D2(outputOS[0], outputOS[1], blockSize, output[0], output[1]);
+    for (size_t i = 0; i < nDeferred;)
+    {
+        size_t n{1};
+        for (auto j = i + 1; j < nDeferred && n < 4; ++j)
+        {
+            if (deferred[i]->filterChainMatches(*deferred[j]))
+                std::swap(deferred[i + n++], deferred[j]);
+        }
+        PolysynthVoice::processMonoFilterGroup(&deferred[i], n);
+        for (auto k = i; k < i + n; ++k)
+        {
+            sst::basic_blocks::mechanics::accumulate_from_to<PolysynthVoice::blockSizeOS>(
+                deferred[k]->outputOS[0], outputOS[0]);
+            sst::basic_blocks::mechanics::accumulate_from_to<PolysynthVoice::blockSizeOS>(
+                deferred[k]->outputOS[1], outputOS[1]);
+        }
+        i += n;
+    }
+
+    if constexpr (PolysynthVariant::oversampling == 1)
+        memcpy(output, outputOS, sizeof(output));
+    else
+        hr_dn.process_block_D2(outputOS[0], outputOS[1], blockSize, output[0], output[1]);
 }
 
 /*
@@ -850,6 +1148,7 @@ void ConduitPolysynth::handleInboundEvent(const clap_event_header_t *evt)
     if (handleParamBaseEvents(evt))
     {
         pushParamsToVoices();
+        requestRestartIfEngineRateChanged();
         return;
     }
 
@@ -866,9 +1165,40 @@ void ConduitPolysynth::handleInboundEvent(const clap_event_header_t *evt)
          * that) streams to do with as you wish. The CLAP_MIDI_EVENT here does the obvious thing.
          */
         auto mevt = reinterpret_cast<const clap_event_midi *>(evt);
+        auto status = mevt->data[0] & 0xF0;
+        int16_t mch = mevt->data[0] & 0x0F;
+        if (status == 0x90 && mevt->data[2] > 0)
+        {
+            NoteOnScheduler::Pending p;
+            p.isMidi = true;
+            std::copy(mevt->data, mevt->data + 3, p.midi);
+            p.port = mevt->port_index;
+            p.channel = mch;
+            p.key = mevt->data[1];
+            p.velocity = mevt->data[2] / 127.f;
+            if (noteOnScheduler.hold(p, evt->time))
+                break;
+        }
+        else if (status == 0x80 || status == 0x90)
+        {
+            if (noteOnScheduler.holdRelease(mevt->port_index, mch, mevt->data[1], -1,
+                                            mevt->data[2] / 127.f, mevt->data))
+                break;
+        }
         sst::voicemanager::applyMidi1Message(voiceManager, mevt->port_index, mevt->data);
         break;
     }
+    /*
+     * MIDI Tuning Standard messages retune the keys and every sounding voice from here on.
+     * Anything else over sysex we don't use.
+     */
+    case CLAP_EVENT_MIDI_SYSEX:
+    {
+        auto sevt = reinterpret_cast<const clap_event_midi_sysex *>(evt);
+        if (tuning.applySysex(sevt->buffer, sevt->size))
+            retuneVoices();
+        break;
+    }
     /*
      * CLAP_EVENT_NOTE_ON and OFF simply deliver the event to the note creators below,
      * which find (probably) and activate a spare or playing voice. Our 'voice stealing'
@@ -878,6 +1208,15 @@ void ConduitPolysynth::handleInboundEvent(const clap_event_header_t *evt)
     case CLAP_EVENT_NOTE_ON:
     {
         auto nevt = reinterpret_cast<const clap_event_note *>(evt);
+        NoteOnScheduler::Pending p;
+        p.port = nevt->port_index;
+        p.channel = nevt->channel;
+        p.key = nevt->key;
+        p.noteId = nevt->note_id;
+        p.velocity = nevt->velocity;
+        if (noteOnScheduler.hold(p, evt->time))
+            break;
+
         voiceManager.processNoteOnEvent(nevt->port_index, nevt->channel, nevt->key, nevt->note_id,
                                         nevt->velocity, 0.f);
     }
@@ -885,6 +1224,10 @@ void ConduitPolysynth::handleInboundEvent(const clap_event_header_t *evt)
     case CLAP_EVENT_NOTE_OFF:
     {
         auto nevt = reinterpret_cast<const clap_event_note *>(evt);
+        if (noteOnScheduler.holdRelease(nevt->port_index, nevt->channel, nevt->key,
+                                        nevt->note_id, nevt->velocity))
+            break;
+
         voiceManager.processNoteOffEvent(nevt->port_index, nevt->channel, nevt->key, nevt->note_id,
                                          nevt->velocity);
     }
@@ -910,6 +1253,14 @@ void ConduitPolysynth::handleInboundEvent(const clap_event_header_t *evt)
     {
         auto pevt = reinterpret_cast<const clap_event_param_mod *>(evt);
 
+        // Per note modulation of a held note waits for that note to start
+        if ((pevt->note_id != -1 || pevt->key != -1) &&
+            noteOnScheduler.holdFollowUp(pevt->port_index, pevt->channel, pevt->key,
+                                         pevt->note_id,
+                                         {NoteOnScheduler::FollowUp::PARAM_MOD, pevt->param_id,
+                                          pevt->amount}))
+            break;
+
         voiceManager.routePolyphonicParameterModulation(pevt->port_index, pevt->channel, pevt->key,
                                                         pevt->note_id, pevt->param_id,
                                                         pevt->amount);
@@ -922,13 +1273,44 @@ void ConduitPolysynth::handleInboundEvent(const clap_event_header_t *evt)
     case CLAP_EVENT_NOTE_EXPRESSION:
     {
         auto pevt = reinterpret_cast<const clap_event_note_expression *>(evt);
+        if (noteOnScheduler.holdFollowUp(pevt->port_index, pevt->channel, pevt->key, pevt->note_id,
+                                         {NoteOnScheduler::FollowUp::EXPRESSION,
+                                          (uint32_t)pevt->expression_id, pevt->value}))
+            break;
         voiceManager.routeNoteExpression(pevt->port_index, pevt->channel, pevt->key, pevt->note_id,
                                          pevt->expression_id, pevt->value);
     }
     break;
+    /*
+     * CLAP_EVENT_NOTE_CHOKE stops the addressed voices at once, with no release.
+     */
+    case CLAP_EVENT_NOTE_CHOKE:
+    {
+        auto nevt = reinterpret_cast<const clap_event_note *>(evt);
+        if (noteOnScheduler.holdFollowUp(nevt->port_index, nevt->channel, nevt->key,
+                                         nevt->note_id, {NoteOnScheduler::FollowUp::CHOKE}))
+            break;
+        chokeVoices(nevt->port_index, nevt->channel, nevt->key, nevt->note_id);
+    }
+    break;
     }
 }
 
+bool ConduitPolysynth::anyVoicePlaying(const FrozenMultisample *ms) const
+{
+    for (const auto &v : voices)
+        if (v.active && v.frozen == ms)
+            return true;
+    return false;
+}
+
+void ConduitPolysynth::retuneVoices()
+{
+    for (auto &v : voices)
+        if (v.active)
+            v.recalcPitch();
+}
+
 PolysynthVoice *ConduitPolysynth::initializeVoice(uint16_t port, uint16_t channel, uint16_t key,
                                                   int32_t noteId, float velocity, float retune)
 {
@@ -938,7 +1320,7 @@ PolysynthVoice *ConduitPolysynth::initializeVoice(uint16_t port, uint16_t channe
         {
             activateVoice(v, port, channel, key, noteId, velocity);
 
-            if (clapJuceShim->isEditorAttached())
+            if (isEditorAttached())
             {
                 auto r = ToUI();
                 r.type = ToUI::MIDI_NOTE_ON;
@@ -952,6 +1334,53 @@ PolysynthVoice *ConduitPolysynth::initializeVoice(uint16_t port, uint16_t channe
     return nullptr;
 }
 
+void ConduitPolysynth::startHeldNote(const NoteOnScheduler::Pending &p)
+{
+    if (p.isMidi)
+        sst::voicemanager::applyMidi1Message(voiceManager, p.port, p.midi);
+    else
+        voiceManager.processNoteOnEvent(p.port, p.channel, p.key, p.noteId, p.velocity, 0.f);
+}
+
+void ConduitPolysynth::releaseHeldNote(const NoteOnScheduler::Pending &p)
+{
+    if (p.isMidi)
+        sst::voicemanager::applyMidi1Message(voiceManager, p.port, p.releaseMidi);
+    else
+        voiceManager.processNoteOffEvent(p.port, p.channel, p.key, p.noteId, p.releaseVelocity);
+}
+
+void ConduitPolysynth::applyHeldFollowUp(const NoteOnScheduler::Pending &p,
+                                         const NoteOnScheduler::FollowUp &f)
+{
+    switch (f.type)
+    {
+    case NoteOnScheduler::FollowUp::EXPRESSION:
+        voiceManager.routeNoteExpression(p.port, p.channel, p.key, p.noteId, f.id, f.value);
+        break;
+    case NoteOnScheduler::FollowUp::PARAM_MOD:
+        voiceManager.routePolyphonicParameterModulation(p.port, p.channel, p.key, p.noteId, f.id,
+                                                        f.value);
+        break;
+    case NoteOnScheduler::FollowUp::CHOKE:
+        chokeVoices(p.port, p.channel, p.key, p.noteId);
+        break;
+    }
+}
+
+void ConduitPolysynth::chokeVoices(int16_t port, int16_t channel, int16_t key, int32_t noteId)
+{
+    for (auto &v : voices)
+    {
+        auto match = noteId != -1 ? v.note_id == noteId
+                                  : (port == -1 || v.portid == port) &&
+                                        (channel == -1 || v.channel == channel) &&
+                                        (key == -1 || v.key == key);
+        if (v.active && match)
+            v.choke();
+    }
+}
+
 void ConduitPolysynth::releaseVoice(PolysynthVoice *sdv, float velocity)
 {
     if (sdv)
@@ -959,7 +1388,7 @@ void ConduitPolysynth::releaseVoice(PolysynthVoice *sdv, float velocity)
         sdv->releaseVelocity = velocity;
         sdv->release();
 
-        if (clapJuceShim->isEditorAttached())
+        if (isEditorAttached())
         {
             auto r = ToUI();
             r.type = ToUI::MIDI_NOTE_OFF;
@@ -972,6 +1401,7 @@ void ConduitPolysynth::releaseVoice(PolysynthVoice *sdv, float velocity)
 void ConduitPolysynth::activateVoice(PolysynthVoice &v, int port_index, int channel, int key,
                                      int noteid, double velocity)
 {
+    v.frozen = frozen;
     v.start(port_index, channel, key, noteid, velocity);
     uiComms.dataCopyForUI.polyphony++;
 }
@@ -985,6 +1415,7 @@ void ConduitPolysynth::paramsFlush(const clap_input_events *in,
                                    const clap_output_events *out) noexcept
 {
     auto sz = in->size(in);
+    noteOnScheduler.noBlock();
 
     // This pointer is the sentinel to our next event which we advance once an event is processed
     for (auto e = 0U; e < sz; ++e)
@@ -996,7 +1427,10 @@ void ConduitPolysynth::paramsFlush(const clap_input_events *in,
     auto ct = handleEventsFromUIQueue(out);
 
     if (ct)
+    {
         pushParamsToVoices();
+        requestRestartIfEngineRateChanged();
+    }
 
     // We will never generate a note end event with processing active, and we have no midi
     // output, so we are done.
@@ -1004,6 +1438,17 @@ void ConduitPolysynth::paramsFlush(const clap_input_events *in,
 
 void ConduitPolysynth::pushParamsToVoices() {}
 
+void ConduitPolysynth::requestRestartIfEngineRateChanged()
+{
+    // The engine rate is chosen at activate, so a change while active needs a host restart
+    auto want = (int)std::round(*paramToValue[pmEngineRate]);
+    if (isActive() && want != activeEngineRateMode && !engineRestartRequested)
+    {
+        engineRestartRequested = true;
+        _host.requestRestart();
+    }
+}
+
 void ConduitPolysynthConfig::PatchExtension::initialize()
 {
     modMatrixConfig = std::make_unique<ModMatrixConfig>();
@@ -1106,6 +1551,26 @@ bool ConduitPolysynthConfig::PatchExtension::fromXml(TiXmlElement *root)
 void ConduitPolysynth::onStateRestored()
 {
     uiComms.dataCopyForUI.populateMatrixView(patch.extension.modMatrixConfig);
+    requestRestartIfEngineRateChanged();
+
+    // A freeze is of the patch that was playing, not the one we just loaded. Patch files
+    // load on the audio thread, so hand this to the main thread.
+    if (freezer.state != PatchFreezer::LIVE)
+    {
+        unfreezeRequested = true;
+        _host.requestCallback();
+    }
+}
+
+void ConduitPolysynth::onMainThread() noexcept
+{
+    if (unfreezeRequested.exchange(false))
+        freezer.unfreeze();
+    // With no audio thread running, do its half of the hand-off here
+    if (!isActive())
+        frozen = freezer.pickUp([this](auto *ms) { return anyVoicePlaying(ms); });
+    freezer.onMainThread();
+    ClapBaseClass::onMainThread();
 }
 
-} // namespace sst::conduit::polysynth
+} // namespace sst::conduit::CONDUIT_POLYSYNTH_NS
@@ -39,34 +39,40 @@
 #include <clap/helpers/plugin.hh>
 
 #include "conduit-shared/sse-include.h"
+#include "variant.h"
 
 #include "sst/basic-blocks/params/ParamMetadata.h"
 #include "sst/basic-blocks/dsp/VUPeak.h"
 #include "sst/filters/HalfRateFilter.h"
 #include "sst/voicemanager/voicemanager.h"
 
+#if CONDUIT_POLYSYNTH_HAS_EFFECTS
 #include "sst/effects/Phaser.h"
 #include "sst/effects/Flanger.h"
 #include "sst/effects/Reverb1.h"
+#endif
 
 #include "conduit-shared/clap-base-class.h"
+#include "conduit-shared/polyphase-upsampler.h"
 #include "voice.h"
+#include "note-on-scheduler.h"
+#include "freeze.h"
 
 struct MTSClient;
 
-namespace sst::conduit::polysynth
+namespace sst::conduit::CONDUIT_POLYSYNTH_NS
 {
 /*
  * This static (defined in the cpp file) allows us to present a name, feature set,
  * url etc... and is consumed by clap-saw-demo-pluginentry.cpp
  */
-static constexpr int nParams{72};
+static constexpr int nParams{77};
 
 struct ModMatrixConfig;
 
 struct ConduitPolysynthConfig
 {
-    static constexpr int nParams{sst::conduit::polysynth::nParams};
+    static constexpr int nParams{sst::conduit::CONDUIT_POLYSYNTH_NS::nParams};
     static constexpr bool baseClassProvidesMonoModSupport{
         false}; // as a synth we do voice level modulation with the VM
     static constexpr bool usesSpecializedMessages{true};
@@ -90,6 +96,9 @@ struct ConduitPolysynthConfig
 
         std::atomic<float> mainVU[2];
 
+        std::atomic<uint32_t> deferredNoteOns{0};
+        std::atomic<float> longestNoteOnDelayMs{0.f};
+
         // s1, s2, target, depth
         using modMessage = std::tuple<int32_t, int32_t, int32_t, float>;
         std::array<modMessage, 8> modMatrixCopy;
@@ -103,6 +112,9 @@ struct ConduitPolysynthConfig
 
         std::atomic<uint16_t> tsig_num, tsig_denom;
 
+        // The freeze controls live on the main thread, as does the editor
+        PatchFreezer *freezer{nullptr};
+
         void populateMatrixView(const std::unique_ptr<ModMatrixConfig> &);
     };
 
@@ -126,6 +138,7 @@ struct ConduitPolysynthConfig
     using specializedMessage_t = SpecializedMessage;
 };
 
+#if CONDUIT_POLYSYNTH_HAS_EFFECTS
 struct PhaserConfig;
 struct FlangerConfig;
 struct Reverb1Config;
@@ -133,16 +146,20 @@ struct Reverb1Config;
 using PhaserFX = sst::effects::phaser::Phaser<PhaserConfig>;
 using FlangerFX = sst::effects::flanger::Flanger<FlangerConfig>;
 using ReverbFX = sst::effects::reverb1::Reverb1<Reverb1Config>;
+#endif
 
 struct ConduitPolysynth
     : sst::conduit::shared::ClapBaseClass<ConduitPolysynth, ConduitPolysynthConfig>
 {
-    static constexpr int max_voices = 64;
+    // Lite builds with fewer; see variant.h
+    static constexpr int max_voices = PolysynthVariant::maxVoices;
+
     ConduitPolysynth(const clap_host *host);
     ~ConduitPolysynth();
 
     bool activate(double sampleRate, uint32_t minFrameCount,
                   uint32_t maxFrameCount) noexcept override;
+    void deactivate() noexcept override;
 
     enum paramIds : uint32_t
     {
@@ -191,6 +208,7 @@ struct ConduitPolysynth
         pmWSDrive,
         pmWSBias,
         pmWSMode,
+        pmWSAntiAlias,
 
         pmFilterRouting = 2300,
         pmFilterFeedback,
@@ -234,11 +252,25 @@ struct ConduitPolysynth
 
         // and finally the main level
         pmOutputLevel = 20100,
+        pmEngineRate,
+
+        pmNoteOnScheduling = 20200,
+        pmNoteOnMaxStarts,
+        pmNoteOnMaxDelay,
 
         // Special parameter indicating no modulation target
         pmNoModTarget = 0x0100BEEF
     };
 
+    enum EngineRateModes
+    {
+        engineAtHostRate = 0,
+        voicesAtEngineRate = 1,
+        voicesAndFXAtEngineRate = 2
+    };
+    // Voices (and optionally fx) run at host rate / N, with N the smallest which gets under this
+    static constexpr double maxEngineRate{96000.0};
+
     static constexpr int offPmFeg{10};
     static constexpr int offPmLFO2{100};
     static constexpr int n_lfos{2};
@@ -274,6 +306,14 @@ struct ConduitPolysynth
         return true;
     }
 
+    /*
+     * Running the engine below the host rate costs us the upsampler's group delay, which
+     * we report so the host can compensate. It only moves in activate (an engine rate
+     * change restarts us) which is the one place CLAP lets us say it changed.
+     */
+    bool implementsLatency() const noexcept override { return true; }
+    uint32_t latencyGet() const noexcept override { return (uint32_t)engineUpsampler.latency(); }
+
     /*
      * process is the meat of the operation. It does obvious things like trigger
      * voices but also handles all the polyphonic modulation and so on. Please see the
@@ -317,9 +357,12 @@ struct ConduitPolysynth
     std::uniform_real_distribution<float> urd;
 
     void onStateRestored() override;
+    void onMainThread() noexcept override;
 
   protected:
+#if !defined(CONDUIT_HEADLESS)
     std::unique_ptr<juce::Component> createEditor() override;
+#endif
 
     friend struct PolysynthVoice;
 
@@ -332,6 +375,31 @@ struct ConduitPolysynth
     float outputOS alignas(16)[2][PolysynthVoice::blockSizeOS];
     sst::filters::HalfRate::HalfRateFilter hr_dn;
 
+    void processEffects(float (&buffer)[2][PolysynthVoice::blockSize], bool modActive,
+                        bool revActive, bool usePhaser);
+    void warmUp();
+
+    /*
+     * When the engine runs below the host rate the voices render into output at the engine
+     * rate and the upsampler brings them to the host rate. The effects run either before it,
+     * at the engine rate, or after it on hostBlock at the host rate.
+     */
+    int activeEngineRateMode{engineAtHostRate};
+    bool fxAtEngineRate{false};
+    bool engineRestartRequested{false};
+    shared::PolyphaseUpsampler engineUpsampler;
+    uint16_t hostBlockPos{0};
+    float hostBlock alignas(16)[2][PolysynthVoice::blockSize];
+    void requestRestartIfEngineRateChanged();
+    double hostSampleRate{0};
+
+    // Caps voice starts per block when enabled. See note-on-scheduler.h
+    NoteOnScheduler noteOnScheduler;
+    void startHeldNote(const NoteOnScheduler::Pending &p);
+    void releaseHeldNote(const NoteOnScheduler::Pending &p);
+    void applyHeldFollowUp(const NoteOnScheduler::Pending &p, const NoteOnScheduler::FollowUp &f);
+    void chokeVoices(int16_t port, int16_t channel, int16_t key, int32_t noteId);
+
     // Voice Management
     struct VMConfig
     {
@@ -354,7 +422,7 @@ struct ConduitPolysynth
         uint16_t port, uint16_t channel, uint16_t key, int32_t noteId, float velocity, float retune)
     {
         voiceInitWorkingBuffer[0] = initializeVoice(port, channel, key, noteId, velocity, retune);
-        return 1;
+        return voiceInitWorkingBuffer[0] ? 1 : 0;
     }
     PolysynthVoice *initializeVoice(uint16_t port, uint16_t channel, uint16_t key, int32_t noteId,
                                     float velocity, float retune);
@@ -400,10 +468,22 @@ struct ConduitPolysynth
     void handleSpecializedFromUI(const FromUI &r);
 
     MTSClient *mtsClient{nullptr};
-
-    std::unique_ptr<PhaserFX> phaserFX;
-    std::unique_ptr<FlangerFX> flangerFX;
-    std::unique_ptr<ReverbFX> reverbFX;
+    // Scala files and MTS sysex; see local-tuning.h
+    sst::conduit::shared::LocalTuning tuning;
+    void retuneVoices();
+
+    // Freezing the patch to a multisample; see freeze.h
+    PatchFreezer freezer{*this};
+    const FrozenMultisample *frozen{nullptr}; // audio thread; what new voices play
+    std::atomic<bool> unfreezeRequested{false};
+    bool anyVoicePlaying(const FrozenMultisample *ms) const;
+
+#if CONDUIT_POLYSYNTH_HAS_EFFECTS
+    // Built in dspArena at activate
+    PhaserFX *phaserFX{nullptr};
+    FlangerFX *flangerFX{nullptr};
+    ReverbFX *reverbFX{nullptr};
+#endif
 
     sst::basic_blocks::dsp::VUPeak mainVU;
 
@@ -473,6 +553,6 @@ struct ModMatrixConfig
         }
     }
 };
-} // namespace sst::conduit::polysynth
+} // namespace sst::conduit::CONDUIT_POLYSYNTH_NS
 
 #endif
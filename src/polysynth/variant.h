@@ -0,0 +1,71 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+#ifndef CONDUIT_SRC_POLYSYNTH_VARIANT_H
+#define CONDUIT_SRC_POLYSYNTH_VARIANT_H
+
+/*
+ * The polysynth sources build twice. As they are they make the full synth; the *-lite.cpp
+ * units define CONDUIT_POLYSYNTH_LITE and include them again to make Polysynth Lite, in
+ * its own namespace. Lite has a smaller voice pool, runs its voices without oversampling
+ * and has no effects, no effect members and no effect panels, so neither the storage nor
+ * the code for what it leaves out is part of it. Parameters and patches are shared.
+ *
+ * Code which differs between the two reads PolysynthVariant, or CONDUIT_POLYSYNTH_HAS_EFFECTS
+ * where a member or a type is missing altogether.
+ */
+
+#include <clap/plugin.h>
+
+#if defined(CONDUIT_POLYSYNTH_LITE)
+#define CONDUIT_POLYSYNTH_NS polysynth_lite
+#define CONDUIT_POLYSYNTH_HAS_EFFECTS 0
+#else
+#define CONDUIT_POLYSYNTH_NS polysynth
+#define CONDUIT_POLYSYNTH_HAS_EFFECTS 1
+#endif
+
+namespace sst::conduit::CONDUIT_POLYSYNTH_NS
+{
+struct PolysynthVariant
+{
+#if defined(CONDUIT_POLYSYNTH_LITE)
+    static constexpr int maxVoices{16};
+    static constexpr int oversampling{1};
+#else
+    static constexpr int maxVoices{64};
+    static constexpr int oversampling{2};
+#endif
+    static_assert(oversampling == 1 || oversampling == 2);
+
+    // What the factory lists. The patch identity is ConduitPolysynthConfig::getDescription
+    static const clap_plugin_descriptor *getDescription();
+};
+} // namespace sst::conduit::CONDUIT_POLYSYNTH_NS
+
+namespace sst::conduit::polysynth_lite
+{
+// For the factory, which only ever sees the full synth's headers
+const clap_plugin_descriptor *getDescription();
+const clap_plugin *create(const clap_host *host);
+} // namespace sst::conduit::polysynth_lite
+
+#endif // CONDUIT_SRC_POLYSYNTH_VARIANT_H
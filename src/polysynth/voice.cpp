@@ -33,14 +33,19 @@
 
 #include "sst/filters/FilterConfiguration.h"
 
-namespace sst::conduit::polysynth
+namespace sst::conduit::CONDUIT_POLYSYNTH_NS
 {
 float pival =
     3.14159265358979323846; // I always forget what you need for M_PI to work on all platforms
 
 void PolysynthVoice::recalcPitch()
 {
-    if (mtsClient && MTS_HasMaster(mtsClient))
+    // A scale loaded or sent to this instance wins over an MTS-ESP master
+    if (!ignoreTuning && synth.tuning.isRetuned())
+    {
+        baseFreq = synth.tuning.current().frequencyFor(key, channel);
+    }
+    else if (mtsClient && MTS_HasMaster(mtsClient))
     {
         baseFreq = MTS_NoteToFrequency(mtsClient, key, channel);
     }
@@ -51,6 +56,14 @@ void PolysynthVoice::recalcPitch()
 
     auto coarseBend =
         pitchNoteExpressionValue + pitchBendWheel + mpePitchBend * 24; // hardocde range for now
+
+    if (frozenZone)
+    {
+        auto f = baseFreq * synth.twoToXTable.twoToThe(coarseBend / 12.0);
+        frozenIncrement = f / frozenZone->rootFreq * frozen->sampleRate * srInv;
+        return;
+    }
+
     if (sawActive)
     {
         for (int i = 0; i < sawUnison; ++i)
@@ -112,7 +125,7 @@ static __m128 wsNoOp(sst::waveshapers::QuadWaveshaperState *__restrict, __m128 i
 
 static __m128 qfNoOp(sst::filters::QuadFilterUnitState *__restrict, __m128 in) { return in; }
 
-void PolysynthVoice::processBlock()
+void PolysynthVoice::processBlock(bool deferMonoFilter)
 {
     static constexpr float vScale{0.2};
     aeg.processBlock(aegValues.attack.value(), aegValues.decay.value(), aegValues.sustain.value(),
@@ -140,6 +153,14 @@ void PolysynthVoice::processBlock()
         }
     }
 
+    filterDeferred = false;
+    if (frozenZone)
+    {
+        renderFrozen();
+        applyOutputStage();
+        return;
+    }
+
     *svfCutoff.internalMod +=
         feg.outBlock0 * fegToSvfCutoff.value() + svfKeytrack.value() * (key - 69);
     *lpfCutoff.internalMod +=
@@ -148,6 +169,21 @@ void PolysynthVoice::processBlock()
     recalcFilter();
     recalcPitch();
 
+    if (stereoSource)
+    {
+        /*
+         * Saw unison is the only stereo source, so once the saw is silent and the two filter
+         * lanes have settled onto each other the voice is mono until the saw comes back.
+         * Mono lanes stay equal, except the comb delay line which only lane 0 writes when
+         * packed, so bring lane 1's up to date on the way back to stereo.
+         */
+        auto nowMono = sawLevel_lipol.v == 0.f && sawLevel.value() == 0.f &&
+                       (monoSource || lanesConverged);
+        if (monoSource && !nowMono && lpfActive)
+            memcpy(delayBufferData[1], delayBufferData[0], sizeof(delayBufferData[0]));
+        monoSource = nowMono;
+    }
+
     memset(outputOS, 0, sizeof(outputOS));
 
     if (sawActive)
@@ -158,15 +194,22 @@ void PolysynthVoice::processBlock()
             float L{0}, R{0};
             auto sl = sawLevel_lipol.v;
             sl = sl * sl * sl;
-            for (int i = 0; i < sawUnison; ++i)
+            if (monoSource)
             {
-                auto out = sawOsc[i].step();
-                L += vScale * sl * sawUniLevelNorm[i] * sawUniPanL[i] * out;
-                R += vScale * sl * sawUniLevelNorm[i] * sawUniPanR[i] * out;
+                L = vScale * sl * sawOsc[0].step();
+            }
+            else
+            {
+                for (int i = 0; i < sawUnison; ++i)
+                {
+                    auto out = sawOsc[i].step();
+                    L += vScale * sl * sawUniLevelNorm[i] * sawUniPanL[i] * out;
+                    R += vScale * sl * sawUniLevelNorm[i] * sawUniPanR[i] * out;
+                }
+                outputOS[1][s] += R;
             }
 
             outputOS[0][s] += L;
-            outputOS[1][s] += R;
             sawLevel_lipol.process();
         }
     }
@@ -181,7 +224,8 @@ void PolysynthVoice::processBlock()
             auto V = vScale * sl * pulseOsc.step();
 
             outputOS[0][s] += V;
-            outputOS[1][s] += V;
+            if (!monoSource)
+                outputOS[1][s] += V;
             pulseLevel_lipol.process();
         }
     }
@@ -197,7 +241,8 @@ void PolysynthVoice::processBlock()
             auto V = vScale * sl * sinOsc.u;
 
             outputOS[0][s] += V;
-            outputOS[1][s] += V;
+            if (!monoSource)
+                outputOS[1][s] += V;
             sinLevel_lipol.process();
         }
     }
@@ -214,7 +259,8 @@ void PolysynthVoice::processBlock()
                      sst::basic_blocks::dsp::correlated_noise_o2mk2_supplied_value(
                          w0, w1, noiseColor.value(), urd(gen));
             outputOS[0][s] += V;
-            outputOS[1][s] += V;
+            if (!monoSource)
+                outputOS[1][s] += V;
 
             noiseLevel_lipol.process();
         }
@@ -222,103 +268,315 @@ void PolysynthVoice::processBlock()
 
     // Filter stage
     aegPFG_lipol.set_target(synth.dbToLinear(aegPFG.value()));
-    aegPFG_lipol.multiply_2_blocks(outputOS[0], outputOS[1]);
+    if (monoSource)
+        aegPFG_lipol.multiply_block(outputOS[0]);
+    else
+        aegPFG_lipol.multiply_2_blocks(outputOS[0], outputOS[1]);
 
     wsDrive_lipol.newValue(synth.dbToLinear(wsDrive.value()));
     wsBias_lipol.newValue(wsBias.value() * (wsActive ? 1.f : 0.f));
     filterFeedback_lipol.newValue(filterFeedback.value());
+
+    // The ADAA shapers keep their own state outside the quad states, so those voices run alone
+    filterDeferred =
+        deferMonoFilter && monoSource && anyFilterStepActive && wsApply == wsWithTable;
+    if (filterDeferred)
+        return;
+
     if (anyFilterStepActive)
+        runFilterChain();
+
+    if (stereoSource && !monoSource)
     {
+        float diff{0.f};
+        for (auto s = 0U; s < blockSizeOS; ++s)
+            diff = std::max(diff, std::fabs(outputOS[0][s] - outputOS[1][s]));
+        lanesConverged = diff < 1e-6f;
+    }
+
+    finishBlock();
+}
+
+void PolysynthVoice::finishBlock()
+{
+    if (!captureBeforeAmp)
+        applyOutputStage();
+}
+
+namespace
+{
+/*
+ * The six filter routings, shared by a voice running its own L/R lanes and by a packed
+ * group of mono voices with one voice per lane. pack loads sample s along with its drive
+ * and bias; unpack stores the result and updates the feedback.
+ */
+template <typename Pack, typename Unpack, typename QF, typename SVF, typename WS>
+inline void runFilterRouting(PolysynthVoice::FilterRouting routing, Pack &&pack,
+                             Unpack &&unpack, QF &&qf, SVF &&svf, WS &&ws)
+{
+    const auto half = _mm_set1_ps(0.5f);
+    __m128 drive, bias;
 
-#define PACK                                                                                       \
-    auto output = _mm_set_ps(0, 0, outputOS[1][s], outputOS[0][s]);                                \
-    auto drive = _mm_set1_ps(wsDrive_lipol.v);                                                     \
-    wsDrive_lipol.process();                                                                       \
-    auto bias = _mm_set1_ps(wsBias_lipol.v);                                                       \
-    wsBias_lipol.process();                                                                        \
-    auto fback = _mm_set1_ps(filterFeedback_lipol.v);                                              \
-    filterFeedback_lipol.process();                                                                \
-    output = _mm_add_ps(output, filterFeedbackSignal)
-
-#define UNPACK                                                                                     \
-    filterFeedbackSignal = _mm_mul_ps(output, fback);                                              \
-    float outArr alignas(16)[4];                                                                   \
-    _mm_store_ps(outArr, output);                                                                  \
-    outputOS[0][s] = outArr[0];                                                                    \
-    outputOS[1][s] = outArr[1]
-
-        switch (filterRouting)
+    switch (routing)
+    {
+    case PolysynthVoice::LowWSMulti:
+        for (auto s = 0U; s < PolysynthVoice::blockSizeOS; ++s)
         {
-        case LowWSMulti:
-            for (auto s = 0U; s < blockSizeOS; ++s)
-            {
-                PACK;
-                output = qfPtr(&qfState, output);
-                output = wsPtr(&wsState, _mm_add_ps(output, bias), drive);
-                output = svfFilterOp(svfImpl, output);
-                UNPACK;
-            }
-            break;
-        case MultiWSLow:
-            for (auto s = 0U; s < blockSizeOS; ++s)
-            {
-                PACK;
-                output = svfFilterOp(svfImpl, output);
-                output = wsPtr(&wsState, _mm_add_ps(output, bias), drive);
-                output = qfPtr(&qfState, output);
-                UNPACK;
-            }
-            break;
-        case WSLowMulti:
-            for (auto s = 0U; s < blockSizeOS; ++s)
-            {
-                PACK;
-                output = wsPtr(&wsState, _mm_add_ps(output, bias), drive);
-                output = qfPtr(&qfState, output);
-                output = svfFilterOp(svfImpl, output);
-                UNPACK;
-            }
-            break;
-        case LowMultiWS:
-            for (auto s = 0U; s < blockSizeOS; ++s)
-            {
-                PACK;
-                output = qfPtr(&qfState, output);
-                output = svfFilterOp(svfImpl, output);
-                output = wsPtr(&wsState, _mm_add_ps(output, bias), drive);
-                UNPACK;
-            }
-            break;
-        case WSPar:
-            for (auto s = 0U; s < blockSizeOS; ++s)
-            {
-                PACK;
-                output = wsPtr(&wsState, _mm_add_ps(output, bias), drive);
-
-                auto outputQ = qfPtr(&qfState, output);
-                auto outputS = svfFilterOp(svfImpl, output);
-                const auto half = _mm_set1_ps(0.5f);
-                output = _mm_mul_ps(half, _mm_add_ps(outputQ, outputS));
-                UNPACK;
-            }
-            break;
-        case ParWS:
-            for (auto s = 0U; s < blockSizeOS; ++s)
+            auto output = pack(s, drive, bias);
+            output = qf(output);
+            output = ws(_mm_add_ps(output, bias), drive);
+            output = svf(output);
+            unpack(s, output);
+        }
+        break;
+    case PolysynthVoice::MultiWSLow:
+        for (auto s = 0U; s < PolysynthVoice::blockSizeOS; ++s)
+        {
+            auto output = pack(s, drive, bias);
+            output = svf(output);
+            output = ws(_mm_add_ps(output, bias), drive);
+            output = qf(output);
+            unpack(s, output);
+        }
+        break;
+    case PolysynthVoice::WSLowMulti:
+        for (auto s = 0U; s < PolysynthVoice::blockSizeOS; ++s)
+        {
+            auto output = pack(s, drive, bias);
+            output = ws(_mm_add_ps(output, bias), drive);
+            output = qf(output);
+            output = svf(output);
+            unpack(s, output);
+        }
+        break;
+    case PolysynthVoice::LowMultiWS:
+        for (auto s = 0U; s < PolysynthVoice::blockSizeOS; ++s)
+        {
+            auto output = pack(s, drive, bias);
+            output = qf(output);
+            output = svf(output);
+            output = ws(_mm_add_ps(output, bias), drive);
+            unpack(s, output);
+        }
+        break;
+    case PolysynthVoice::WSPar:
+        for (auto s = 0U; s < PolysynthVoice::blockSizeOS; ++s)
+        {
+            auto output = pack(s, drive, bias);
+            output = ws(_mm_add_ps(output, bias), drive);
+
+            auto outputQ = qf(output);
+            auto outputS = svf(output);
+            output = _mm_mul_ps(half, _mm_add_ps(outputQ, outputS));
+            unpack(s, output);
+        }
+        break;
+    case PolysynthVoice::ParWS:
+        for (auto s = 0U; s < PolysynthVoice::blockSizeOS; ++s)
+        {
+            auto output = pack(s, drive, bias);
+            auto outputQ = qf(output);
+            auto outputS = svf(output);
+            output = _mm_mul_ps(half, _mm_add_ps(outputQ, outputS));
+            output = ws(_mm_add_ps(output, bias), drive);
+            unpack(s, output);
+        }
+        break;
+    }
+}
+
+/*
+ * Lane moves for packing mono voices. A mono voice feeds the same signal to every lane it
+ * uses, so we gather lane 0 of each voice into one register and scatter the result back
+ * broadcast, which keeps the voice's lanes equal if it turns stereo again.
+ */
+struct FilterLanes
+{
+    sst::filters::QuadFilterUnitState &qf;
+    sst::waveshapers::QuadWaveshaperState &ws;
+    PolysynthVoice::StereoSimperSVF &svf;
+    __m128 &feedback;
+};
+
+inline FilterLanes lanesOf(PolysynthVoice &v)
+{
+    return {v.qfState, v.wsState, v.svfImpl, v.filterFeedbackSignal};
+}
+
+template <typename Move> inline void forEachLaneRegister(Move &&move)
+{
+    using qf_t = sst::filters::QuadFilterUnitState;
+    for (auto c = 0U; c < sizeof(qf_t::C) / sizeof(qf_t::C[0]); ++c)
+    {
+        move([c](FilterLanes l) -> __m128 & { return l.qf.C[c]; });
+        move([c](FilterLanes l) -> __m128 & { return l.qf.dC[c]; });
+    }
+    for (auto r = 0U; r < sizeof(qf_t::R) / sizeof(qf_t::R[0]); ++r)
+        move([r](FilterLanes l) -> __m128 & { return l.qf.R[r]; });
+    for (auto r = 0U; r < sst::waveshapers::n_waveshaper_registers; ++r)
+        move([r](FilterLanes l) -> __m128 & { return l.ws.R[r]; });
+
+    move([](FilterLanes l) -> __m128 & { return l.svf.ic1eq; });
+    move([](FilterLanes l) -> __m128 & { return l.svf.ic2eq; });
+    move([](FilterLanes l) -> __m128 & { return l.svf.g; });
+    move([](FilterLanes l) -> __m128 & { return l.svf.k; });
+    move([](FilterLanes l) -> __m128 & { return l.svf.gk; });
+    move([](FilterLanes l) -> __m128 & { return l.svf.a1; });
+    move([](FilterLanes l) -> __m128 & { return l.svf.a2; });
+    move([](FilterLanes l) -> __m128 & { return l.svf.a3; });
+    move([](FilterLanes l) -> __m128 & { return l.svf.ak; });
+    move([](FilterLanes l) -> __m128 & { return l.ws.init; });
+    move([](FilterLanes l) -> __m128 & { return l.feedback; });
+}
+} // namespace
+
+void PolysynthVoice::runFilterChain()
+{
+    // A mono voice feeds L into both filter lanes; the right lane is never read again below
+    float *filterInR = monoSource ? outputOS[0] : outputOS[1];
+    __m128 fback;
+
+    runFilterRouting(
+        filterRouting,
+        [&](auto s, auto &drive, auto &bias) {
+            drive = _mm_set1_ps(wsDrive_lipol.v);
+            wsDrive_lipol.process();
+            bias = _mm_set1_ps(wsBias_lipol.v);
+            wsBias_lipol.process();
+            fback = _mm_set1_ps(filterFeedback_lipol.v);
+            filterFeedback_lipol.process();
+            return _mm_add_ps(_mm_set_ps(0, 0, filterInR[s], outputOS[0][s]),
+                              filterFeedbackSignal);
+        },
+        [&](auto s, auto output) {
+            filterFeedbackSignal = _mm_mul_ps(output, fback);
+            float outArr alignas(16)[4];
+            _mm_store_ps(outArr, output);
+            outputOS[0][s] = outArr[0];
+            outputOS[1][s] = outArr[1];
+        },
+        [this](auto in) { return qfPtr(&qfState, in); },
+        [this](auto in) { return svfFilterOp(svfImpl, in); },
+        [this](auto in, auto drive) { return wsApply(*this, in, drive); });
+}
+
+bool PolysynthVoice::filterChainMatches(const PolysynthVoice &o) const
+{
+    return filterRouting == o.filterRouting && qfPtr == o.qfPtr && wsPtr == o.wsPtr &&
+           wsApply == o.wsApply && svfActive == o.svfActive &&
+           (!svfActive || svfMode == o.svfMode);
+}
+
+void PolysynthVoice::processMonoFilterGroup(PolysynthVoice *const *v, size_t n)
+{
+    assert(n >= 1 && n <= 4);
+    auto &lead = *v[0];
+    if (n == 1)
+    {
+        lead.runFilterChain();
+        lead.finishBlock();
+        return;
+    }
+
+    // Start from the lead voice so anything shared across lanes carries over, then move each
+    // voice into its lane. Lanes past n repeat the lead voice and their output is dropped.
+    auto lane = [&](size_t i) -> PolysynthVoice & { return *v[i < n ? i : 0]; };
+    auto qf = lead.qfState;
+    auto ws = lead.wsState;
+    auto svf = lead.svfImpl;
+    auto feedback = _mm_setzero_ps();
+    FilterLanes packed{qf, ws, svf, feedback};
+
+    forEachLaneRegister([&](auto reg) {
+        auto ab = _mm_unpacklo_ps(reg(lanesOf(lane(0))), reg(lanesOf(lane(1))));
+        auto cd = _mm_unpacklo_ps(reg(lanesOf(lane(2))), reg(lanesOf(lane(3))));
+        reg(packed) = _mm_movelh_ps(ab, cd);
+    });
+    // Padding lanes write the lead's spare comb lines, never the ones a voice reads
+    for (auto i = n; i < 4; ++i)
+        qf.active[i] = 0;
+    for (auto i = 0U; i < n; ++i)
+    {
+        qf.DB[i] = v[i]->qfState.DB[0];
+        qf.WP[i] = v[i]->qfState.WP[0];
+        qf.active[i] = v[i]->qfState.active[0];
+    }
+
+    __m128 fback;
+    runFilterRouting(
+        lead.filterRouting,
+        [&](auto s, auto &drive, auto &bias) {
+            auto &v0 = lane(0), &v1 = lane(1), &v2 = lane(2), &v3 = lane(3);
+            drive = _mm_setr_ps(v0.wsDrive_lipol.v, v1.wsDrive_lipol.v, v2.wsDrive_lipol.v,
+                                v3.wsDrive_lipol.v);
+            bias = _mm_setr_ps(v0.wsBias_lipol.v, v1.wsBias_lipol.v, v2.wsBias_lipol.v,
+                               v3.wsBias_lipol.v);
+            fback = _mm_setr_ps(v0.filterFeedback_lipol.v, v1.filterFeedback_lipol.v,
+                                v2.filterFeedback_lipol.v, v3.filterFeedback_lipol.v);
+            for (auto i = 0U; i < n; ++i)
             {
-                PACK;
-                auto outputQ = qfPtr(&qfState, output);
-                auto outputS = svfFilterOp(svfImpl, output);
-                const auto half = _mm_set1_ps(0.5f);
-                output = _mm_mul_ps(half, _mm_add_ps(outputQ, outputS));
-                output = wsPtr(&wsState, _mm_add_ps(output, bias), drive);
-
-                UNPACK;
+                v[i]->wsDrive_lipol.process();
+                v[i]->wsBias_lipol.process();
+                v[i]->filterFeedback_lipol.process();
             }
-            break;
-        }
+            auto in = _mm_setr_ps(v0.outputOS[0][s], v1.outputOS[0][s], v2.outputOS[0][s],
+                                  v3.outputOS[0][s]);
+            return _mm_add_ps(in, feedback);
+        },
+        [&](auto s, auto output) {
+            feedback = _mm_mul_ps(output, fback);
+            float outArr alignas(16)[4];
+            _mm_store_ps(outArr, output);
+            for (auto i = 0U; i < n; ++i)
+                v[i]->outputOS[0][s] = outArr[i];
+        },
+        [&](auto in) { return lead.qfPtr(&qf, in); },
+        [&](auto in) { return lead.svfFilterOp(svf, in); },
+        [&](auto in, auto drive) { return lead.wsPtr(&ws, in, drive); });
+
+    forEachLaneRegister([&](auto reg) {
+        auto p = reg(packed);
+        reg(lanesOf(*v[0])) = _mm_shuffle_ps(p, p, _MM_SHUFFLE(0, 0, 0, 0));
+        reg(lanesOf(*v[1])) = _mm_shuffle_ps(p, p, _MM_SHUFFLE(1, 1, 1, 1));
+        if (n > 2)
+            reg(lanesOf(*v[2])) = _mm_shuffle_ps(p, p, _MM_SHUFFLE(2, 2, 2, 2));
+        if (n > 3)
+            reg(lanesOf(*v[3])) = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 3, 3));
+    });
+    for (auto i = 0U; i < n; ++i)
+    {
+        for (auto &wp : v[i]->qfState.WP)
+            wp = qf.WP[i];
+        v[i]->finishBlock();
+    }
+}
+
+void PolysynthVoice::renderFrozen()
+{
+    const auto &z = *frozenZone;
+    auto len = z.length();
+    auto loopLen = (double)(len - z.loopStart);
+    for (auto s = 0U; s < blockSizeOS; ++s)
+    {
+        auto i = (size_t)frozenPos;
+        auto j = i + 1 < len ? i + 1 : z.loopStart;
+        auto f = (float)(frozenPos - i);
+
+        outputOS[0][s] = z.data[0][i] + f * (z.data[0][j] - z.data[0][i]);
+        if (!monoSource)
+            outputOS[1][s] = z.data[1][i] + f * (z.data[1][j] - z.data[1][i]);
+
+        frozenPos += frozenIncrement;
+        while (frozenPos >= len)
+            frozenPos -= loopLen;
     }
+}
+
+void PolysynthVoice::applyOutputStage()
+{
     sst::basic_blocks::mechanics::scale_by<blockSizeOS>(aeg.outputCache, outputOS[0]);
-    sst::basic_blocks::mechanics::scale_by<blockSizeOS>(aeg.outputCache, outputOS[1]);
+    if (!monoSource)
+        sst::basic_blocks::mechanics::scale_by<blockSizeOS>(aeg.outputCache, outputOS[1]);
 
     auto olv = outputLevel.value();
     auto velSen = velocitySens.value();
@@ -328,10 +586,30 @@ void PolysynthVoice::processBlock()
     olv = olv * olv * olv;
 
     outputLevel_lipol.set_target(olv);
-    outputLevel_lipol.multiply_2_blocks(outputOS[0], outputOS[1]);
+    if (monoSource)
+        outputLevel_lipol.multiply_block(outputOS[0]);
+    else
+        outputLevel_lipol.multiply_2_blocks(outputOS[0], outputOS[1]);
 
     auto opv = outputPan.value();
-    if (opv != 0.f)
+    if (monoSource)
+    {
+        // Expand to stereo here, folding the pan matrix since both inputs are the same
+        float pl{1.f}, pr{1.f};
+        if (opv != 0.f)
+        {
+            sst::basic_blocks::dsp::pan_laws::panmatrix_t panMatrix;
+            sst::basic_blocks::dsp::pan_laws::stereoTruePanning((opv + 1) * 0.5, panMatrix);
+            pl = panMatrix[0] + panMatrix[2];
+            pr = panMatrix[1] + panMatrix[3];
+        }
+        for (auto s = 0U; s < blockSizeOS; ++s)
+        {
+            outputOS[1][s] = pr * outputOS[0][s];
+            outputOS[0][s] = pl * outputOS[0][s];
+        }
+    }
+    else if (opv != 0.f)
     {
         sst::basic_blocks::dsp::pan_laws::panmatrix_t panMatrix;
         sst::basic_blocks::dsp::pan_laws::stereoTruePanning((opv + 1) * 0.5, panMatrix);
@@ -355,6 +633,9 @@ void PolysynthVoice::start(int16_t porti, int16_t channeli, int16_t keyi, int32_
     note_id = noteidi;
     velocity = veli;
 
+    frozenZone = frozen ? &frozen->zoneFor(key) : nullptr;
+    frozenPos = 0;
+
     pitchBendWheel = 0;
     mpePitchBend = 0;
     filterFeedbackSignal = _mm_setzero_ps();
@@ -428,6 +709,16 @@ void PolysynthVoice::start(int16_t porti, int16_t channeli, int16_t keyi, int32_
     for (auto &o : sawOsc)
         o.retrigger();
 
+    // Everything before the pan stage is identical in both channels unless saw unison spreads it
+    stereoSource = sawActive && sawUnison > 1;
+    monoSource = !stereoSource;
+    lanesConverged = false;
+    if (frozenZone)
+    {
+        stereoSource = false;
+        monoSource = frozen->mono;
+    }
+
     recalcPitch();
     recalcFilter();
 
@@ -460,6 +751,9 @@ void PolysynthVoice::start(int16_t porti, int16_t channeli, int16_t keyi, int32_
         case Fuzz:
             type = sst::waveshapers::WaveshaperType::wst_fuzz;
             break;
+        case Hard:
+            type = sst::waveshapers::WaveshaperType::wst_hard;
+            break;
         }
         sst::waveshapers::initializeWaveshaperRegister(type, R);
 
@@ -469,10 +763,34 @@ void PolysynthVoice::start(int16_t porti, int16_t channeli, int16_t keyi, int32_
         }
         wsState.init = _mm_cmpneq_ps(_mm_setzero_ps(), _mm_setzero_ps());
         wsPtr = sst::waveshapers::GetQuadWaveshaper(type);
+
+        // The other shapes have no tidy antiderivative so stay on the table shaper
+        auto antiAlias = static_cast<WaveshaperAntiAlias>(
+            *synth.paramToValue.at(ConduitPolysynth::pmWSAntiAlias));
+        auto second = antiAlias == ADAASecondOrder;
+        wsApply = wsWithTable;
+        if (antiAlias != OversampledOnly)
+        {
+            switch (wsTypeEnum)
+            {
+            case Soft:
+                useADAA<&PolysynthVoice::softADAA1, &PolysynthVoice::softADAA2>(second);
+                break;
+            case Hard:
+                useADAA<&PolysynthVoice::hardADAA1, &PolysynthVoice::hardADAA2>(second);
+                break;
+            case FullWaveRect:
+                useADAA<&PolysynthVoice::rectADAA1, &PolysynthVoice::rectADAA2>(second);
+                break;
+            default:
+                break;
+            }
+        }
     }
     else
     {
         wsPtr = wsNoOp;
+        wsApply = wsWithTable;
     }
 
     lpfActive = static_cast<bool>(*synth.paramToValue.at(ConduitPolysynth::pmLPFActive));
@@ -701,7 +1019,7 @@ void PolysynthVoice::StereoSimperSVF::init()
     ic2eq = _mm_setzero_ps();
 }
 
-void PolysynthVoice::attachTo(sst::conduit::polysynth::ConduitPolysynth &p)
+void PolysynthVoice::attachTo(ConduitPolysynth &p)
 {
     auto attach = [this, &p](clap_id parm, ModulatedValue &toThat) {
         p.attachParam(parm, toThat.base);
@@ -805,4 +1123,4 @@ void PolysynthVoice::receiveNoteExpression(int expression, double value)
     }
 }
 
-} // namespace sst::conduit::polysynth
\ No newline at end of file
+} // namespace sst::conduit::CONDUIT_POLYSYNTH_NS
\ No newline at end of file
@@ -31,6 +31,10 @@
 
 #include "conduit-shared/debug-helpers.h"
 #include "conduit-shared/sse-include.h"
+#include "conduit-shared/envelope-rate-table.h"
+#include "conduit-shared/adaa.h"
+#include "freeze.h"
+#include "variant.h"
 
 #include "sst/basic-blocks/dsp/DPWSawPulseOscillator.h"
 #include "sst/basic-blocks/dsp/QuadratureOscillators.h"
@@ -43,7 +47,7 @@
 
 struct MTSClient;
 
-namespace sst::conduit::polysynth
+namespace sst::conduit::CONDUIT_POLYSYNTH_NS
 {
 
 struct ConduitPolysynth;
@@ -52,7 +56,7 @@ struct PolysynthVoice
 {
     static constexpr int max_uni{7};
     static constexpr int blockSize{8};
-    static constexpr int blockSizeOS{blockSize << 1};
+    static constexpr int blockSizeOS{blockSize * PolysynthVariant::oversampling};
 
     const ConduitPolysynth &synth;
     PolysynthVoice(const ConduitPolysynth &sy)
@@ -67,6 +71,7 @@ struct PolysynthVoice
     void setSampleRate(double sr)
     {
         samplerate = sr;
+        envelopeRates = shared::EnvelopeRateTable::forSampleRate(sr);
         aeg.onSampleRateChanged();
         feg.onSampleRateChanged();
     }
@@ -119,7 +124,15 @@ struct PolysynthVoice
         Digital,
         FullWaveRect,
         WestcoastFold,
-        Fuzz
+        Fuzz,
+        Hard
+    };
+
+    enum WaveshaperAntiAlias
+    {
+        OversampledOnly,
+        ADAAFirstOrder,
+        ADAASecondOrder
     };
 
     enum LPFTypes
@@ -139,6 +152,11 @@ struct PolysynthVoice
     // Saw Oscillator
     int sawUnison{3};
     bool sawActive{true};
+
+    // True when L == R up to the pan stage. We then only compute L and expand at the end.
+    bool monoSource{false};
+    // A voice with saw unison can be stereo, but is mono for the blocks where the saw is silent
+    bool stereoSource{false}, lanesConverged{false};
     ModulatedValue sawUnisonDetune, sawCoarse, sawFine, sawLevel;
     sst::basic_blocks::dsp::lipol<float, blockSizeOS, true> sawLevel_lipol;
     std::array<float, max_uni> sawUniPanL, sawUniPanR, sawUniVoiceDetune, sawUniLevelNorm;
@@ -229,12 +247,40 @@ struct PolysynthVoice
         ModulatedValue rate, deform, amplitude;
     } lfoData[2];
 
-    void processBlock();
+    /*
+     * With deferMonoFilter a mono voice stops before its filter chain and sets filterDeferred.
+     * The caller then runs matching deferred voices four to an SSE register through
+     * processMonoFilterGroup, which also finishes their blocks.
+     */
+    void processBlock(bool deferMonoFilter = false);
+    bool filterDeferred{false};
+    bool filterChainMatches(const PolysynthVoice &other) const;
+    static void processMonoFilterGroup(PolysynthVoice *const *voices, size_t count);
+    void runFilterChain();
+    void finishBlock();
 
     float outputOS alignas(16)[2][blockSizeOS];
 
+    // Sample playback mode. Set frozen before start and the voice plays the nearest zone
+    // through its own AEG and output stage instead of running the oscillators and filters.
+    const FrozenMultisample *frozen{nullptr};
+    const FrozenMultisample::Zone *frozenZone{nullptr};
+    double frozenPos{0}, frozenIncrement{1};
+    void renderFrozen();
+    void applyOutputStage();
+
+    // For the freeze renderer: stop before the AEG, and render at equal temperament
+    bool captureBeforeAmp{false};
+    bool ignoreTuning{false};
+
     void start(int16_t port, int16_t channel, int16_t key, int32_t noteid, double velocity);
     void release();
+    // A choked voice stops at once; the synth ends it like any other at the end of the block
+    void choke()
+    {
+        gated = false;
+        aeg.stage = env_t::s_eoc;
+    }
 
     float baseFrequencyByMidiKey[128];
     void recalcPitch();
@@ -255,8 +301,12 @@ struct PolysynthVoice
             mpeTimbre = midi1CC[cc];
     }
 
-    // Sigh - fix this to a table of course
-    inline float envelope_rate_linear_nowrap(float f) { return blockSizeOS * srInv * pow(2.f, -f); }
+    const shared::EnvelopeRateTable *envelopeRates{nullptr};
+    inline float envelope_rate_linear_nowrap(float f)
+    {
+        assert(envelopeRates);
+        return blockSizeOS * envelopeRates->rateLinear(f);
+    }
 
     inline bool isPlaying() const { return aeg.stage < env_t::s_eoc; }
 
@@ -289,6 +339,35 @@ struct PolysynthVoice
     sst::waveshapers::QuadWaveshaperPtr wsPtr{nullptr};
     sst::waveshapers::QuadWaveshaperState wsState;
 
+    /*
+     * The waveshaper stage as the filter routings call it. Usually this forwards to wsPtr,
+     * but with anti-aliasing on the shapes which have a closed form antiderivative (soft,
+     * hard and rectifier) run through one of the ADAA shapers instead.
+     */
+    using WSApply = __m128 (*)(PolysynthVoice &, __m128 in, __m128 drive);
+    WSApply wsApply{wsWithTable};
+    static __m128 wsWithTable(PolysynthVoice &v, __m128 in, __m128 drive)
+    {
+        return v.wsPtr(&v.wsState, in, drive);
+    }
+    template <auto shaper> static __m128 wsWithADAA(PolysynthVoice &v, __m128 in, __m128 drive)
+    {
+        return (v.*shaper).process(_mm_mul_ps(in, drive));
+    }
+    template <auto first, auto second> void useADAA(bool secondOrder)
+    {
+        (this->*first).reset();
+        (this->*second).reset();
+        wsApply = secondOrder ? wsWithADAA<second> : wsWithADAA<first>;
+    }
+
+    shared::adaa::FirstOrder<shared::adaa::CubicSoftClip> softADAA1;
+    shared::adaa::SecondOrder<shared::adaa::CubicSoftClip> softADAA2;
+    shared::adaa::FirstOrder<shared::adaa::HardClip> hardADAA1;
+    shared::adaa::SecondOrder<shared::adaa::HardClip> hardADAA2;
+    shared::adaa::FirstOrder<shared::adaa::Rectifier> rectADAA1;
+    shared::adaa::SecondOrder<shared::adaa::Rectifier> rectADAA2;
+
     sst::filters::FilterUnitQFPtr qfPtr{nullptr};
     sst::filters::QuadFilterUnitState qfState;
     sst::filters::FilterType qfType;
@@ -312,5 +391,5 @@ struct PolysynthVoice
     double baseFreq{440.0};
     double srInv{1.0 / 44100.0};
 };
-} // namespace sst::conduit::polysynth
+} // namespace sst::conduit::CONDUIT_POLYSYNTH_NS
 #endif
@@ -55,7 +55,8 @@ struct RMPanel : sst::jucegui::accessibility::IgnoredComponent
         auto mlBx = bx.translated(0, sz).withHeight(20);
         mixLabel->setBounds(mlBx);
 
-        mlBx = mlBx.translated(0, 20).withHeight(30);
+        // Four algorithms, so stack them
+        mlBx = mlBx.translated(0, 20).withHeight(68);
 
         model->setBounds(mlBx);
     }
@@ -112,7 +113,7 @@ struct ConduitRingModulatorEditor : public sst::jucegui::accessibility::IgnoredC
         sourcePanel->setContentAreaComponent(std::move(soct));
         addAndMakeVisible(*sourcePanel);
 
-        setSize(300, 200);
+        setSize(300, 240);
 
         comms->startProcessing();
     }
@@ -143,7 +144,7 @@ RMPanel::RMPanel(sst::conduit::ring_modulator::editor::uicomm_t &p,
     mixLabel->setText("Mix");
     addAndMakeVisible(*mixLabel);
 
-    model = std::make_unique<jcmp::MultiSwitch>(jcmp::MultiSwitch::HORIZONTAL);
+    model = std::make_unique<jcmp::MultiSwitch>(jcmp::MultiSwitch::VERTICAL);
 
     addAndMakeVisible(*model);
     e.comms->attachDiscreteToParam(model.get(), cps_t::paramIds::pmAlgo);
@@ -20,7 +20,9 @@
  */
 
 #include "ring-modulator.h"
+#if !defined(CONDUIT_HEADLESS)
 #include "juce_gui_basics/juce_gui_basics.h"
+#endif
 #include "sst/basic-blocks/mechanics/block-ops.h"
 #include "version.h"
 
@@ -70,9 +72,12 @@ ConduitRingModulator::ConduitRingModulator(const clap_host *host)
             .withName("Algorithm")
             .withGroupName("Ring Modulator")
             .withDefault(0)
-            .withRange(0, 1)
+            .withRange(algoDigital, algoAnalogADAA2)
             .withFlags(steppedFlag)
-            .withUnorderedMapFormatting({{algoDigital, "Digital"}, {algoAnalog, "Analog"}}));
+            .withUnorderedMapFormatting({{algoDigital, "Digital"},
+                                         {algoAnalog, "Analog"},
+                                         {algoAnalogADAA1, "Analog 1x ADAA"},
+                                         {algoAnalogADAA2, "Analog 1x ADAA2"}}));
 
     paramDescriptions.push_back(
         ParamDesc()
@@ -94,14 +99,15 @@ ConduitRingModulator::ConduitRingModulator(const clap_host *host)
                                     .withGroupName("Ring Modulator"));
     configureParams();
 
+    flightRecorder.stateNames = {"algo", "", "", ""};
+
     attachParam(pmMixLevel, mix);
     attachParam(pmInternalSourceFrequency, freq);
 
     attachParam(pmAlgo, algo);
     attachParam(pmSource, src);
 
-    clapJuceShim = std::make_unique<sst::clap_juce_shim::ClapJuceShim>(this);
-    clapJuceShim->setResizable(true);
+    setupEditorShim(true);
 }
 
 ConduitRingModulator::~ConduitRingModulator() {}
@@ -167,6 +173,9 @@ float diode_sim(float v)
 
 clap_process_status ConduitRingModulator::process(const clap_process *process) noexcept
 {
+    auto frBlock = flightRecorder.scopedBlock(process);
+    auto trBlock = traceScope("process");
+
     handleEventsFromUIQueue(process->out_events);
 
     if (process->audio_outputs_count <= 0)
@@ -200,7 +209,9 @@ clap_process_status ConduitRingModulator::process(const clap_process *process) n
         nextEvent = ev->get(ev, nextEventIndex);
     }
 
-    auto isDigital = *algo < 0.5;
+    auto algoNow = (Algos)std::round(*algo);
+    auto isDigital = algoNow == algoDigital;
+    flightRecorder.setState(0, *algo);
 
     for (auto i = 0U; i < process->frames_count; ++i)
     {
@@ -224,7 +235,16 @@ clap_process_status ConduitRingModulator::process(const clap_process *process) n
 
         pos++;
 
-        if (pos == blockSize)
+        if (pos == blockSize && (algoNow == algoAnalogADAA1 || algoNow == algoAnalogADAA2))
+        {
+            memcpy(inMixBuf, inputBuf, sizeof(inMixBuf));
+            if (algoNow == algoAnalogADAA1)
+                diodesAt1x(diodesADAA1);
+            else
+                diodesAt1x(diodesADAA2);
+            pos = 0;
+        }
+        else if (pos == blockSize)
         {
             memcpy(inMixBuf, inputBuf, sizeof(inMixBuf));
             hr_up.process_block_U2(inputBuf[0], inputBuf[1], inputOS[0], inputOS[1], blockSizeOS);
@@ -286,6 +306,46 @@ clap_process_status ConduitRingModulator::process(const clap_process *process) n
     return CLAP_PROCESS_CONTINUE;
 }
 
+/*
+ * The analog algorithm without the resampling. The source is scaled as in the oversampled
+ * path, and the two diode pairs for each channel are the four lanes of one ADAA shaper.
+ */
+template <typename ADAA> void ConduitRingModulator::diodesAt1x(ADAA &adaa)
+{
+    if ((Source)(*src) == srcInternal)
+    {
+        static constexpr double mf0{8.17579891564};
+        internalSource.setRate(2.0 * M_PI * note_to_pitch_ignoring_tuning(freq.v + 69) * mf0 *
+                               dsamplerate_inv);
+
+        for (int i = 0; i < blockSize; ++i)
+        {
+            internalSource.step();
+            source[0][i] = 2 * internalSource.u;
+            source[1][i] = 2 * internalSource.u;
+        }
+    }
+    else
+    {
+        memcpy(source, sidechainBuf, sizeof(source));
+        mech::scale_by<blockSize>(4, source[0], source[1]);
+    }
+
+    // A = vc + vin / 2 and B = vc - vin / 2, and each diode pair is d(x) + d(-x)
+    const auto halfIn = _mm_set_ps(-0.5f, -0.5f, 0.5f, 0.5f);
+    for (int s = 0; s < blockSize; ++s)
+    {
+        auto vin = _mm_set_ps(inputBuf[1][s], inputBuf[0][s], inputBuf[1][s], inputBuf[0][s]);
+        auto vc = _mm_set_ps(source[1][s], source[0][s], source[1][s], source[0][s]);
+        auto pairs = adaa.process(_mm_add_ps(vc, _mm_mul_ps(halfIn, vin)));
+
+        float r alignas(16)[4];
+        _mm_store_ps(r, pairs);
+        outBuf[0][s] = r[0] - r[2];
+        outBuf[1][s] = r[1] - r[3];
+    }
+}
+
 void ConduitRingModulator::handleInboundEvent(const clap_event_header_t *evt)
 {
     if (handleParamBaseEvents(evt))
@@ -34,6 +34,7 @@
 #include "sst/filters/HalfRateFilter.h"
 
 #include "conduit-shared/clap-base-class.h"
+#include "conduit-shared/adaa.h"
 
 namespace sst::conduit::ring_modulator
 {
@@ -65,6 +66,8 @@ struct ConduitRingModulator
                   uint32_t maxFrameCount) noexcept override
     {
         setSampleRate(sampleRate);
+        diodesADAA1.reset();
+        diodesADAA2.reset();
         return true;
     }
 
@@ -81,7 +84,10 @@ struct ConduitRingModulator
     enum Algos : uint32_t
     {
         algoDigital = 0,
-        algoAnalog = 1
+        algoAnalog = 1,
+        // The analog diodes at 1x, antialiased by antiderivative rather than oversampling
+        algoAnalogADAA1 = 2,
+        algoAnalogADAA2 = 3
     };
 
     enum Source : uint32_t
@@ -126,7 +132,9 @@ struct ConduitRingModulator
     typedef std::unordered_map<int, int> PatchPluginExtension;
 
   protected:
+#if !defined(CONDUIT_HEADLESS)
     std::unique_ptr<juce::Component> createEditor() override;
+#endif
     std::atomic<bool> refreshUIValues{false};
 
     sst::filters::HalfRate::HalfRateFilter hr_up, hr_scup, hr_down;
@@ -137,6 +145,12 @@ struct ConduitRingModulator
     float inputOS alignas(16)[2][blockSizeOS];
     float sidechainBuf alignas(16)[2][blockSize];
     float sourceOS alignas(16)[2][blockSizeOS];
+    float source alignas(16)[2][blockSize];
+
+    // Lanes are the A and B diode pair inputs for left and right
+    shared::adaa::FirstOrder<shared::adaa::DiodePair> diodesADAA1;
+    shared::adaa::SecondOrder<shared::adaa::DiodePair> diodesADAA2;
+    template <typename ADAA> void diodesAt1x(ADAA &adaa);
 
     float outBuf[2][blockSize]{};
     float inMixBuf[2][blockSize]{};
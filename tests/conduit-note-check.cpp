@@ -0,0 +1,398 @@
+/*
+ * Conduit - a project highlighting CLAP-first development
+ *           and exercising the surge synth team libraries.
+ *
+ * Copyright 2023-2024 Paul Walker and authors in github
+ *
+ * This file you are viewing now is released under the
+ * MIT license as described in LICENSE.md
+ *
+ * The assembled program which results from compiling this
+ * project has GPL3 dependencies, so if you distribute
+ * a binary, the combined work would be a GPL3 product.
+ *
+ * Roughly, that means you are welcome to copy the code and
+ * ideas in the src/ directory, but perhaps not code from elsewhere
+ * if you are closed source or non-GPL3. And if you do copy this code
+ * you will need to replace some of the dependencies. Please see
+ * the discussion in README.md for further information on what this may
+ * mean for you.
+ */
+
+/*
+ * Headless checks on the note processors, through the clap factory and the bench host.
+ * Every note on they emit gets a matching note off, and note expressions and polyphonic
+ * modulation aimed at one played note reach exactly the notes generated from it, whether
+ * it arrived as a clap note with an id or as MIDI. Exits non zero on a failure, so it
+ * runs under ctest when the tests are built.
+ *
+ *    conduit-note-check
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <clap/entry.h>
+
+#include "bench-host.h"
+
+using namespace sst::conduit::benchmarks;
+
+namespace
+{
+static constexpr clap_id chordMemoryKeyShift{7241};
+static constexpr clap_id downstreamParam{1234};
+
+// Input events of mixed types, and the notes which come out the other side
+struct CheckEvents
+{
+    std::vector<clap_event_param_value> params;
+    std::vector<clap_event_note> notes;
+    std::vector<clap_event_note_expression> expressions;
+    std::vector<clap_event_param_mod> mods;
+    std::vector<clap_event_midi> midis;
+    std::vector<const clap_event_header_t *> order;
+    std::vector<clap_event_note> emitted;
+    std::vector<clap_event_note_expression> emittedExpressions;
+    std::vector<clap_event_param_mod> emittedMods;
+    std::vector<clap_event_midi> emittedMidi;
+    clap_input_events in{};
+    clap_output_events out{};
+
+    CheckEvents()
+    {
+        params.reserve(16);
+        notes.reserve(16);
+        expressions.reserve(16);
+        mods.reserve(16);
+        midis.reserve(16);
+        in.ctx = this;
+        in.size = [](auto l) {
+            return (uint32_t) static_cast<CheckEvents *>(l->ctx)->order.size();
+        };
+        in.get = [](auto l, auto i) { return static_cast<CheckEvents *>(l->ctx)->order[i]; };
+        out.ctx = this;
+        out.try_push = [](auto l, auto e) {
+            auto self = static_cast<CheckEvents *>(l->ctx);
+            if (e->space_id != CLAP_CORE_EVENT_SPACE_ID)
+                return true;
+            switch (e->type)
+            {
+            case CLAP_EVENT_NOTE_ON:
+            case CLAP_EVENT_NOTE_OFF:
+                self->emitted.push_back(*reinterpret_cast<const clap_event_note *>(e));
+                break;
+            case CLAP_EVENT_NOTE_EXPRESSION:
+                self->emittedExpressions.push_back(
+                    *reinterpret_cast<const clap_event_note_expression *>(e));
+                break;
+            case CLAP_EVENT_PARAM_MOD:
+                self->emittedMods.push_back(*reinterpret_cast<const clap_event_param_mod *>(e));
+                break;
+            case CLAP_EVENT_MIDI:
+                self->emittedMidi.push_back(*reinterpret_cast<const clap_event_midi *>(e));
+                break;
+            }
+            return true;
+        };
+    }
+
+    void param(clap_id id, double value)
+    {
+        clap_event_param_value p{};
+        p.header.size = sizeof(p);
+        p.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        p.header.type = CLAP_EVENT_PARAM_VALUE;
+        p.param_id = id;
+        p.note_id = -1;
+        p.port_index = -1;
+        p.channel = -1;
+        p.key = -1;
+        p.value = value;
+        params.push_back(p);
+        order.push_back(&params.back().header);
+    }
+    void note(bool on, int16_t key, int32_t noteId)
+    {
+        clap_event_note n{};
+        n.header.size = sizeof(n);
+        n.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        n.header.type = on ? CLAP_EVENT_NOTE_ON : CLAP_EVENT_NOTE_OFF;
+        n.key = key;
+        n.note_id = noteId;
+        n.velocity = 0.8;
+        notes.push_back(n);
+        order.push_back(&notes.back().header);
+    }
+    void expression(int16_t key, int32_t noteId, double value)
+    {
+        clap_event_note_expression n{};
+        n.header.size = sizeof(n);
+        n.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        n.header.type = CLAP_EVENT_NOTE_EXPRESSION;
+        n.expression_id = CLAP_NOTE_EXPRESSION_TUNING;
+        n.port_index = 0;
+        n.channel = 0;
+        n.key = key;
+        n.note_id = noteId;
+        n.value = value;
+        expressions.push_back(n);
+        order.push_back(&expressions.back().header);
+    }
+    void mod(int16_t key, int32_t noteId, double amount)
+    {
+        clap_event_param_mod p{};
+        p.header.size = sizeof(p);
+        p.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        p.header.type = CLAP_EVENT_PARAM_MOD;
+        p.param_id = downstreamParam;
+        p.port_index = 0;
+        p.channel = 0;
+        p.key = key;
+        p.note_id = noteId;
+        p.amount = amount;
+        mods.push_back(p);
+        order.push_back(&mods.back().header);
+    }
+    void midi(bool on, uint8_t key)
+    {
+        clap_event_midi m{};
+        m.header.size = sizeof(m);
+        m.header.space_id = CLAP_CORE_EVENT_SPACE_ID;
+        m.header.type = CLAP_EVENT_MIDI;
+        m.port_index = 0;
+        m.data[0] = on ? 0x90 : 0x80;
+        m.data[1] = key;
+        m.data[2] = 100;
+        midis.push_back(m);
+        order.push_back(&midis.back().header);
+    }
+    void clearInput()
+    {
+        params.clear();
+        notes.clear();
+        expressions.clear();
+        mods.clear();
+        midis.clear();
+        order.clear();
+    }
+    void clearOutput()
+    {
+        emitted.clear();
+        emittedExpressions.clear();
+        emittedMods.clear();
+        emittedMidi.clear();
+    }
+};
+
+void process(PluginRunner &r, CheckEvents &ev)
+{
+    clap_process p{};
+    p.frames_count = r.blockSize;
+    p.audio_inputs = r.inBuffers.data();
+    p.audio_inputs_count = (uint32_t)r.inBuffers.size();
+    p.audio_outputs = r.outBuffers.data();
+    p.audio_outputs_count = (uint32_t)r.outBuffers.size();
+    p.in_events = &ev.in;
+    p.out_events = &ev.out;
+    r.plugin->process(r.plugin, &p);
+    ev.clearInput();
+}
+
+// Every key turned on must have been turned off again
+bool allReleased(const std::vector<clap_event_note> &emitted, std::string &why)
+{
+    int held[128]{};
+    for (const auto &e : emitted)
+        held[e.key] += e.header.type == CLAP_EVENT_NOTE_ON ? 1 : -1;
+    for (int k = 0; k < 128; ++k)
+    {
+        if (held[k] != 0)
+        {
+            why = "key " + std::to_string(k) + " left at " + std::to_string(held[k]);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool chordMemoryReleases(const clap_plugin_factory *f, double shift, int16_t key)
+{
+    PluginRunner r(f, "org.surge-synth-team.conduit.chord-memory", 48000, 64);
+    if (!r.init() || !r.activate() || !r.startProcessing())
+    {
+        fprintf(stderr, "chord-memory: failed to start\n");
+        return false;
+    }
+
+    CheckEvents ev;
+    ev.param(chordMemoryKeyShift, shift);
+    ev.note(true, key, 1);
+    process(r, ev);
+    ev.note(false, key, 1);
+    process(r, ev);
+
+    r.stopProcessing();
+    r.deactivate();
+
+    std::string why;
+    auto ok = !ev.emitted.empty() && allReleased(ev.emitted, why);
+    printf("%s chord-memory shift %+.0f key %d %s\n", ok ? "PASS" : "FAIL", shift, key,
+           ev.emitted.empty() ? "emitted nothing" : why.c_str());
+    return ok;
+}
+
+// The (key, note id) pairs a list of per note events was sent to, in a stable order
+template <typename E> std::vector<std::pair<int, int>> targets(const std::vector<E> &events)
+{
+    std::vector<std::pair<int, int>> res;
+    for (const auto &e : events)
+        res.emplace_back(e.key, e.note_id);
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+std::string describe(const std::vector<std::pair<int, int>> &t)
+{
+    std::string res;
+    for (const auto &[k, id] : t)
+        res += " (" + std::to_string(k) + "," + std::to_string(id) + ")";
+    return res.empty() ? " nothing" : res;
+}
+
+bool sameTargets(const char *what, const std::vector<std::pair<int, int>> &got,
+                 std::vector<std::pair<int, int>> want)
+{
+    std::sort(want.begin(), want.end());
+    auto ok = got == want;
+    printf("%s chord-memory %s reached%s", ok ? "PASS" : "FAIL", what, describe(got).c_str());
+    if (!ok)
+        printf(", wanted%s", describe(want).c_str());
+    printf("\n");
+    return ok;
+}
+
+int32_t emittedIdFor(const std::vector<clap_event_note> &emitted, int16_t key)
+{
+    for (const auto &e : emitted)
+        if (e.header.type == CLAP_EVENT_NOTE_ON && e.key == key)
+            return e.note_id;
+    return -2;
+}
+
+/*
+ * Two clap notes held with a shift of 7, so each has one companion with a fresh id. An
+ * expression and a modulation for one parent, by note id and then by key, must reach
+ * that parent and its companion and nothing from the other parent.
+ */
+bool chordMemoryFansOutById(const clap_plugin_factory *f)
+{
+    PluginRunner r(f, "org.surge-synth-team.conduit.chord-memory", 48000, 64);
+    if (!r.init() || !r.activate() || !r.startProcessing())
+    {
+        fprintf(stderr, "chord-memory: failed to start\n");
+        return false;
+    }
+
+    CheckEvents ev;
+    ev.param(chordMemoryKeyShift, 7);
+    ev.note(true, 60, 1);
+    ev.note(true, 64, 2);
+    process(r, ev);
+    auto companion1 = emittedIdFor(ev.emitted, 67);
+    auto companion2 = emittedIdFor(ev.emitted, 71);
+
+    bool ok{true};
+    if (companion1 < 0 || companion1 == 1 || companion1 == companion2)
+    {
+        printf("FAIL chord-memory companion ids %d %d\n", companion1, companion2);
+        ok = false;
+    }
+
+    ev.clearOutput();
+    ev.expression(60, 1, 0.5);
+    ev.mod(60, 1, 0.25);
+    process(r, ev);
+    ok &= sameTargets("expression by id", targets(ev.emittedExpressions),
+                      {{60, 1}, {67, companion1}});
+    ok &= sameTargets("param mod by id", targets(ev.emittedMods), {{60, 1}, {67, companion1}});
+
+    ev.clearOutput();
+    ev.expression(64, -1, 0.5);
+    ev.mod(64, -1, 0.25);
+    process(r, ev);
+    ok &= sameTargets("expression by key", targets(ev.emittedExpressions),
+                      {{64, -1}, {71, companion2}});
+    ok &= sameTargets("param mod by key", targets(ev.emittedMods), {{64, -1}, {71, companion2}});
+
+    ev.note(false, 60, 1);
+    ev.note(false, 64, 2);
+    process(r, ev);
+    r.stopProcessing();
+    r.deactivate();
+    return ok;
+}
+
+/*
+ * The same over MIDI, where nothing carries an id. Expressions and modulation addressed
+ * by key reach the played key and its companion, and the other held key's companion is
+ * left alone. Every MIDI note on must be matched by a note off.
+ */
+bool chordMemoryFansOutOverMidi(const clap_plugin_factory *f)
+{
+    PluginRunner r(f, "org.surge-synth-team.conduit.chord-memory", 48000, 64);
+    if (!r.init() || !r.activate() || !r.startProcessing())
+    {
+        fprintf(stderr, "chord-memory: failed to start\n");
+        return false;
+    }
+
+    CheckEvents ev;
+    ev.param(chordMemoryKeyShift, 7);
+    ev.midi(true, 60);
+    ev.midi(true, 64);
+    process(r, ev);
+
+    bool ok{true};
+    ev.expression(60, -1, 0.5);
+    ev.mod(60, -1, 0.25);
+    process(r, ev);
+    ok &= sameTargets("midi expression by key", targets(ev.emittedExpressions),
+                      {{60, -1}, {67, -1}});
+    ok &= sameTargets("midi param mod by key", targets(ev.emittedMods), {{60, -1}, {67, -1}});
+
+    ev.midi(false, 60);
+    ev.midi(false, 64);
+    process(r, ev);
+    r.stopProcessing();
+    r.deactivate();
+
+    int held[128]{};
+    for (const auto &m : ev.emittedMidi)
+        held[m.data[1]] += (m.data[0] & 0xF0) == 0x90 ? 1 : -1;
+    auto released = std::all_of(std::begin(held), std::end(held), [](auto h) { return h == 0; });
+    printf("%s chord-memory midi notes released\n", released ? "PASS" : "FAIL");
+    return ok && released;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    clap_entry.init(argv[0]);
+    auto f = static_cast<const clap_plugin_factory *>(
+        clap_entry.get_factory(CLAP_PLUGIN_FACTORY_ID));
+
+    bool ok{true};
+    // A zero shift, and the default shift clamped back onto the top key, have no companion
+    ok &= chordMemoryReleases(f, 0, 60);
+    ok &= chordMemoryReleases(f, 7, 127);
+    ok &= chordMemoryReleases(f, 7, 60);
+    ok &= chordMemoryFansOutById(f);
+    ok &= chordMemoryFansOutOverMidi(f);
+
+    clap_entry.deinit();
+    return ok ? 0 : 1;
+}